@@ -0,0 +1,418 @@
+#ifndef __AGGREGATINGHASHTABLE_HPP__
+#define __AGGREGATINGHASHTABLE_HPP__
+
+#include "HashTable.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace specialized_datatypes
+{
+
+// Aggregate policies: identity value, folding an input into the aggregate, merging two
+// partial aggregates and ordering used for top-K extraction (heavier first).
+
+struct count_aggregate
+{
+    using input_type    = size_t;
+    using value_type    = size_t;
+
+    [[nodiscard]]
+    constexpr static value_type identity    () noexcept
+    {
+        return 0;
+    }
+
+    constexpr static void add               (value_type & aggregate, input_type input) noexcept
+    {
+        aggregate += input;
+    }
+
+    constexpr static void merge             (value_type & aggregate, value_type const & other) noexcept
+    {
+        aggregate += other;
+    }
+
+    [[nodiscard]]
+    constexpr static bool is_heavier        (value_type const & lhs, value_type const & rhs) noexcept
+    {
+        return lhs > rhs;
+    }
+};
+
+template <typename V>
+struct statistics_aggregate
+{
+    struct value_type
+    {
+        size_t  count;
+        V       sum;
+        V       min;
+        V       max;
+    };
+
+    using input_type = V;
+
+    [[nodiscard]]
+    constexpr static value_type identity    () noexcept
+    {
+        return {0, V{}, std::numeric_limits<V>::max(), std::numeric_limits<V>::lowest()};
+    }
+
+    constexpr static void add               (value_type & aggregate, input_type const & input) noexcept
+    {
+        ++aggregate.count;
+        aggregate.sum   += input;
+        aggregate.min   = std::min(aggregate.min, input);
+        aggregate.max   = std::max(aggregate.max, input);
+    }
+
+    constexpr static void merge             (value_type & aggregate, value_type const & other) noexcept
+    {
+        aggregate.count += other.count;
+        aggregate.sum   += other.sum;
+        aggregate.min   = std::min(aggregate.min, other.min);
+        aggregate.max   = std::max(aggregate.max, other.max);
+    }
+
+    [[nodiscard]]
+    constexpr static bool is_heavier        (value_type const & lhs, value_type const & rhs) noexcept
+    {
+        return lhs.count > rhs.count || (lhs.count == rhs.count && lhs.sum > rhs.sum);
+    }
+};
+
+// Open addressing table keeping a fixed size aggregate next to every key, stored as (key, aggregate)
+// entries of an open_addressing_hash_set which hashes and compares their keys only. Hasher maps a key
+// straight to its bucket, predicate compares keys and may supply empty_type rejecting a sentinel key.
+template < typename Key, typename AggregatePolicy, typename HashFunction, typename Predicate>
+class aggregating_hash_table
+{
+public:
+
+    using key_type              = Key;
+    using aggregate_policy_type = AggregatePolicy;
+    using aggregate_type        = typename aggregate_policy_type::value_type;
+    using input_type            = typename aggregate_policy_type::input_type;
+    using value_type            = std::pair<key_type, aggregate_type>;
+    using const_reference       = value_type const &;
+    using hash_function_type    = HashFunction;
+    using predicate_type        = Predicate;
+    using empty_type            = typename detail::empty_type_of<predicate_type>::type;
+
+private:
+
+    using self_type = aggregating_hash_table<Key, AggregatePolicy, HashFunction, Predicate>;
+
+    // Entries are hashed by key, bare keys are accepted so that lookups build no entry.
+    struct entry_hasher
+    {
+        using is_transparent = void;
+
+        [[nodiscard]]
+        constexpr size_t operator () (value_type const & entry) const
+        {
+            return i_hash_function(entry.first);
+        }
+
+        [[nodiscard]]
+        constexpr size_t operator () (key_type const & key) const
+        {
+            return i_hash_function(key);
+        }
+
+        hash_function_type i_hash_function;
+    };
+
+    // Compares keys of entries, bare keys and the empty sentinel of the key predicate.
+    struct entry_predicate
+    {
+        using is_transparent    = void;
+        using empty_type        = typename aggregating_hash_table::empty_type;
+
+        template <typename LhsT, typename RhsT>
+        [[nodiscard]]
+        constexpr bool operator () (LhsT const & lhs, RhsT const & rhs) const
+        {
+            return i_predicate(key_of(lhs), key_of(rhs));
+        }
+
+        [[nodiscard]]
+        constexpr static key_type const & key_of (value_type const & entry) noexcept
+        {
+            return entry.first;
+        }
+
+        template <typename T>
+        [[nodiscard]]
+        constexpr static T const & key_of (T const & key) noexcept
+        {
+            return key;
+        }
+
+        predicate_type i_predicate;
+    };
+
+    using table_type = open_addressing_hash_set<value_type, entry_hasher, entry_predicate>;
+
+public:
+
+    using table_is_full     = typename table_type::table_is_full;
+    using const_iterator    = typename table_type::const_iterator;
+
+    class batch_size_mismatch : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Keys and inputs batches must be of the same size";
+        }
+    };
+
+    constexpr explicit aggregating_hash_table   (   size_t              reserve_count
+                                                ,   hash_function_type  hasher      = hash_function_type()
+                                                ,   predicate_type      predicator  = predicate_type()
+                                                )
+    :   i_table (reserve_count, entry_hasher{hasher}, entry_predicate{predicator})
+    {
+    }
+
+    // Folds input into aggregate of the key, inserting the key first if needed.
+    // Returns true if the key was inserted.
+    constexpr bool upsert_add                   (key_type const & key, input_type const & input)
+    {
+        auto [it, is_inserted] = i_table.try_emplace(key, key, aggregate_policy_type::identity());
+        if (it != end()) aggregate_policy_type::add(aggregate_of(it), input);
+
+        return is_inserted;
+    }
+
+    // As above, the key is moved into the table when inserted.
+    constexpr bool upsert_add                   (key_type && key, input_type const & input)
+    {
+        auto [it, is_inserted] = i_table.try_emplace(key, std::move(key), aggregate_policy_type::identity());
+        if (it != end()) aggregate_policy_type::add(aggregate_of(it), input);
+
+        return is_inserted;
+    }
+
+    // Batched upsert_add(keys[i], inputs[i]), buckets of following keys are prefetched ahead.
+    constexpr void upsert_add                   (   std::span<key_type const>   keys
+                                                ,   std::span<input_type const> inputs
+                                                )
+    {
+        if (keys.size() != inputs.size()) throw batch_size_mismatch();
+
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (i + s_prefetch_distance < keys.size()) prefetch(keys[i + s_prefetch_distance]);
+            upsert_add(keys[i], inputs[i]);
+        }
+    }
+
+    // Batched upsert_add(keys[i], 1), e.g. occurrence counting.
+    constexpr void upsert_add                   (std::span<key_type const> keys)
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (i + s_prefetch_distance < keys.size()) prefetch(keys[i + s_prefetch_distance]);
+            upsert_add(keys[i], input_type{1});
+        }
+    }
+
+    // Merges every aggregate of other table into this one.
+    constexpr void merge                        (self_type const & other)
+    {
+        for (auto const & [key, aggregate] : other)
+        {
+            auto [it, is_inserted] = i_table.try_emplace(key, key, aggregate_policy_type::identity());
+            aggregate_policy_type::merge(aggregate_of(it), aggregate);
+        }
+    }
+
+    // Merges every aggregate of other table into this one and empties other, keys are moved over.
+    // Entries leave other one by one as they are merged, so after table_is_full this table holds
+    // the merged part and other exactly the rest: neither is counted twice or lost as long as both
+    // end up drained into the same table.
+    constexpr void drain                        (self_type & other)
+    {
+        for (auto entry = other.begin(); entry != other.end(); )
+        {
+            auto & [key, aggregate] = entry_of(entry);
+
+            auto [it, is_inserted] = i_table.try_emplace(key, std::move(key), aggregate_policy_type::identity());
+            aggregate_policy_type::merge(aggregate_of(it), aggregate);
+
+            entry = other.i_table.erase(entry);
+        }
+
+        // Drops erased buckets left behind.
+        other.clear();
+    }
+
+    constexpr void clear                        () noexcept
+    {
+        i_table.clear();
+    }
+
+    // Returns up to k entries with heaviest aggregates, heaviest first.
+    [[nodiscard]]
+    std::vector<value_type> top_k               (size_t k) const
+    {
+        return top_k(k, &aggregate_policy_type::is_heavier);
+    }
+
+    template <typename CompareT>
+    [[nodiscard]]
+    std::vector<value_type> top_k               (size_t k, CompareT is_heavier) const
+    {
+        std::vector<value_type const *> entries;
+        entries.reserve(size());
+        for (auto const & entry : *this) entries.push_back(std::addressof(entry));
+
+        k = std::min(k, entries.size());
+        std::partial_sort   (   entries.begin(), entries.begin() + k, entries.end()
+                            ,   [&is_heavier](value_type const * lhs, value_type const * rhs)
+                                {
+                                    return is_heavier(lhs->second, rhs->second);
+                                }
+                            );
+
+        std::vector<value_type> result;
+        result.reserve(k);
+        for (size_t i = 0; i < k; ++i) result.push_back(*entries[i]);
+
+        return result;
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator find               (key_type const & key) const
+    {
+        return i_table.find(key);
+    }
+
+    constexpr void prefetch                     (key_type const & key) const noexcept
+    {
+        i_table.prefetch(key);
+    }
+
+    [[nodiscard]]
+    constexpr size_t capacity                   () const noexcept
+    {
+        return i_table.capacity();
+    }
+
+    [[nodiscard]]
+    constexpr size_t size                       () const noexcept
+    {
+        return i_table.size();
+    }
+
+    [[nodiscard]]
+    constexpr bool is_empty                     () const noexcept
+    {
+        return i_table.is_empty();
+    }
+
+    [[nodiscard]]
+    constexpr hash_function_type const & hasher () const noexcept
+    {
+        return i_table.hasher().i_hash_function;
+    }
+
+    [[nodiscard]]
+    constexpr predicate_type const & predicate  () const noexcept
+    {
+        return i_table.predicate().i_predicate;
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator begin              () const noexcept
+    {
+        return i_table.begin();
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator end                () const noexcept
+    {
+        return i_table.end();
+    }
+
+private:
+
+    // Entries are created non const inside the table, which looks at their keys only,
+    // so aggregates may be updated in place. Keys may be moved from right before erasure only.
+    [[nodiscard]]
+    constexpr static value_type & entry_of      (const_iterator it) noexcept
+    {
+        return const_cast<value_type &>(*it);
+    }
+
+    [[nodiscard]]
+    constexpr static aggregate_type & aggregate_of (const_iterator it) noexcept
+    {
+        return entry_of(it).second;
+    }
+
+    table_type              i_table;
+
+    constexpr static size_t s_prefetch_distance = 8;
+};
+
+// Per thread partial aggregating tables. Every thread folds events into its own partial
+// without synchronization; flush merges all partials into the target and empties them.
+// flush must not run concurrently with updates of the partials. If flush throws table_is_full,
+// the target keeps what was merged and the partials only what was not: drain the target into
+// a bigger one, then flush into that one.
+template <typename AggregatingTableT>
+class partial_aggregation
+{
+    struct alignas(64) padded_table
+    {
+        AggregatingTableT i_table;
+    };
+
+public:
+
+    using table_type = AggregatingTableT;
+
+    partial_aggregation         (   size_t              partials_count
+                                ,   table_type const &  prototype
+                                )
+    :   i_partials  (partials_count, padded_table{prototype})
+    {
+    }
+
+    [[nodiscard]]
+    table_type & partial        (size_t index) noexcept
+    {
+        return i_partials[index].i_table;
+    }
+
+    [[nodiscard]]
+    size_t partials_count       () const noexcept
+    {
+        return i_partials.size();
+    }
+
+    void flush                  (table_type & target)
+    {
+        for (auto & partial : i_partials)
+        {
+            target.drain(partial.i_table);
+        }
+    }
+
+private:
+    std::vector<padded_table> i_partials;
+};
+
+}
+
+#endif // __AGGREGATINGHASHTABLE_HPP__
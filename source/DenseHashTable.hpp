@@ -0,0 +1,347 @@
+#ifndef __DENSEHASHTABLE_HPP__
+#define __DENSEHASHTABLE_HPP__
+
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace specialized_datatypes
+{
+
+// Open addressing set with elements kept densely in insertion order and buckets holding
+// IndexT positions into the element array only.
+//
+// Iteration walks a contiguous array, empty buckets cost sizeof(IndexT) instead of sizeof(T)
+// and no sentinel values of T are needed. Erase moves the last element into the hole, so
+// the order is insertion order up to erasures. HashFunction maps a value to a bucket of a
+// table of given size, as for open_addressing_hash_set.
+template < typename T, typename HashFunction, typename Predicate, typename IndexT = uint32_t>
+class dense_hash_set
+{
+    static_assert(std::is_unsigned_v<IndexT>, "Bucket index must be an unsigned integer");
+
+    using value_container_type  = std::vector<T>;
+    using index_container_type  = std::vector<IndexT>;
+
+    constexpr static IndexT s_empty_index   = std::numeric_limits<IndexT>::max();
+    constexpr static IndexT s_erased_index  = std::numeric_limits<IndexT>::max() - 1;
+
+public:
+
+    class table_is_full : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Table is full";
+        }
+    };
+
+    class rebalancing_size_too_small : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Rebalancing size must be bigger then current table size";
+        }
+    };
+
+    class capacity_too_large : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Capacity exceeds range of the bucket index type";
+        }
+    };
+
+    using value_type            = T;
+    using const_reference       = T const &;
+    using index_type            = IndexT;
+    using hash_function_type    = HashFunction;
+    using predicate_type        = Predicate;
+    using const_iterator        = typename value_container_type::const_iterator;
+
+    constexpr explicit dense_hash_set   (   size_t              reserve_count
+                                        ,   hash_function_type  hasher      = hash_function_type()
+                                        ,   predicate_type      predicator  = predicate_type()
+                                        )
+    :   i_values            ()
+    ,   i_indices           (checked_capacity(reserve_count), s_empty_index)
+    ,   i_hash_function     (hasher)
+    ,   i_predicate         (predicator)
+    ,   i_erased            ()
+    {
+    }
+
+    // The value is moved into the table only when inserted, otherwise it is left intact.
+    constexpr bool emplace                      (value_type && value)
+    {
+        auto [position, is_found] = find_insert_position(value);
+
+        if (is_found) return false;
+
+        // Erased buckets consumed all the headroom, rehash in place drops them.
+        if (position == capacity() && i_erased > 0)
+        {
+            rebalance(capacity());
+            position = find_insert_position(value).first;
+        }
+
+        if (position == capacity()) throw table_is_full();
+
+        // Bucket is claimed only once the element is in place, a throwing push_back leaves no dangling index.
+        i_values.push_back(std::move(value));
+        i_indices[position] = static_cast<index_type>(i_values.size() - 1);
+
+        return true;
+    }
+
+    template <typename... Args>
+    constexpr bool emplace                      (Args &&... args)
+    {
+        return emplace(value_type(std::forward<Args>(args)...));
+    }
+
+    // The last element takes place of the erased one.
+    constexpr size_t erase                      (const_reference value)
+    {
+        auto const position = find_position(value);
+
+        if (position == capacity()) return 0;
+
+        auto const index = i_indices[position];
+        release_bucket(position);
+
+        auto const last = static_cast<index_type>(i_values.size() - 1);
+        if (index != last)
+        {
+            i_indices[find_index_position(last)]    = index;
+            i_values[index]                         = std::move(i_values[last]);
+        }
+        i_values.pop_back();
+
+        return 1;
+    }
+
+    template<typename HasherT>
+    constexpr void rebalance                    (   size_t reserve_count
+                                                ,   HasherT && rebalance_hasher
+                                                )
+    {
+        if (reserve_count < size()) throw rebalancing_size_too_small();
+        if (reserve_count > s_erased_index) throw capacity_too_large();
+
+        i_hash_function = std::forward<HasherT>(rebalance_hasher);
+        rebalance(reserve_count);
+    }
+
+    // Rebuilds buckets only, elements stay in place.
+    constexpr void rebalance                    (size_t reserve_count)
+    {
+        if (reserve_count < size()) throw rebalancing_size_too_small();
+
+        i_indices.assign(checked_capacity(reserve_count), s_empty_index);
+        i_erased = 0;
+
+        for (size_t index = 0; index < i_values.size(); ++index)
+        {
+            auto const position = find_insert_position(i_values[index]).first;
+            i_indices[position] = static_cast<index_type>(index);
+        }
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator find               (const_reference value) const
+    {
+        auto const position = find_position(value);
+
+        if (position == capacity()) return end();
+
+        return begin() + i_indices[position];
+    }
+
+    // Hints bucket of the value into cache ahead of find / emplace, lets batched probes overlap memory latency.
+    constexpr void prefetch                     (const_reference value) const noexcept
+    {
+        if (std::is_constant_evaluated() || capacity() == 0) return;
+
+        __builtin_prefetch(i_indices.data() + hasher()(value));
+    }
+
+    [[nodiscard]]
+    constexpr size_t capacity                   () const noexcept
+    {
+        return i_indices.size();
+    }
+
+    [[nodiscard]]
+    constexpr size_t size                       () const noexcept
+    {
+        return i_values.size();
+    }
+
+    [[nodiscard]]
+    constexpr size_t max_size                   () const noexcept
+    {
+        return capacity();
+    }
+
+    [[nodiscard]]
+    constexpr bool is_empty                     () const noexcept
+    {
+        return i_values.empty();
+    }
+
+    // Bytes held by elements and buckets.
+    [[nodiscard]]
+    constexpr size_t memory_usage               () const noexcept
+    {
+        return i_values.capacity() * sizeof(value_type) + i_indices.capacity() * sizeof(index_type);
+    }
+
+    // Elements in insertion order (up to erasures), contiguous.
+    [[nodiscard]]
+    constexpr std::span<value_type const> values () const noexcept
+    {
+        return i_values;
+    }
+
+    [[nodiscard]]
+    constexpr hash_function_type const & hasher () const noexcept
+    {
+        return i_hash_function;
+    }
+
+    [[nodiscard]]
+    constexpr predicate_type const & predicate  () const noexcept
+    {
+        return i_predicate;
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator begin              () const noexcept
+    {
+        return i_values.begin();
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator cbegin             () const noexcept
+    {
+        return begin();
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator end                () const noexcept
+    {
+        return i_values.end();
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator cend               () const noexcept
+    {
+        return end();
+    }
+
+private:
+
+    // Both sentinels must stay out of the index range.
+    [[nodiscard]]
+    constexpr static size_t checked_capacity    (size_t reserve_count)
+    {
+        if (reserve_count > s_erased_index) throw capacity_too_large();
+
+        return reserve_count;
+    }
+
+    [[nodiscard]]
+    constexpr static bool is_occupied_index     (index_type index) noexcept
+    {
+        return index < s_erased_index;
+    }
+
+    // Returns bucket holding the value, or capacity() if it is missing.
+    [[nodiscard]]
+    constexpr size_t find_position              (const_reference value) const
+    {
+        auto const count_limit = capacity();
+        if (count_limit == 0) return count_limit;
+
+        auto const expected_position = hasher()(value);
+        for (size_t steps = 0; steps < count_limit; ++steps)
+        {
+            auto const position = (expected_position + steps) % count_limit;
+            auto const index    = i_indices[position];
+            if (index == s_empty_index) break;
+            if (is_occupied_index(index) && predicate()(i_values[index], value)) return position;
+        }
+
+        return count_limit;
+    }
+
+    // Returns bucket holding the value and true, or first empty bucket on its probe path and false.
+    // The bucket is capacity() if the table is full.
+    [[nodiscard]]
+    constexpr std::pair<size_t, bool> find_insert_position (const_reference value) const
+    {
+        auto const count_limit = capacity();
+        if (count_limit == 0) return {count_limit, false};
+
+        auto const expected_position = hasher()(value);
+        for (size_t steps = 0; steps < count_limit; ++steps)
+        {
+            auto const position = (expected_position + steps) % count_limit;
+            auto const index    = i_indices[position];
+            if (index == s_empty_index) return {position, false};
+            if (is_occupied_index(index) && predicate()(i_values[index], value)) return {position, true};
+        }
+
+        return {count_limit, false};
+    }
+
+    // Bucket referring to the element at index, found along the element's probe path.
+    [[nodiscard]]
+    constexpr size_t find_index_position        (index_type index) const
+    {
+        auto const count_limit          = capacity();
+        auto const expected_position    = hasher()(i_values[index]);
+
+        size_t position = expected_position % count_limit;
+        while (i_indices[position] != index) position = (position + 1) % count_limit;
+
+        return position;
+    }
+
+    // Marks bucket erased. Erased buckets directly followed by an empty one end no probe
+    // sequence, so they are turned into empty ones.
+    constexpr void release_bucket               (size_t position) noexcept
+    {
+        auto const count_limit = capacity();
+
+        i_indices[position] = s_erased_index;
+        ++i_erased;
+
+        if (i_indices[(position + 1) % count_limit] != s_empty_index) return;
+
+        for (size_t steps = 0; steps < count_limit && i_indices[position] == s_erased_index; ++steps)
+        {
+            i_indices[position] = s_empty_index;
+            --i_erased;
+            position = (position + count_limit - 1) % count_limit;
+        }
+    }
+
+    value_container_type    i_values;
+    index_container_type    i_indices;
+    hash_function_type      i_hash_function;
+    predicate_type          i_predicate;
+    size_t                  i_erased;
+};
+
+}
+
+#endif // __DENSEHASHTABLE_HPP__
@@ -0,0 +1,552 @@
+#ifndef __DISKPARTITIONEDHASHSET_HPP__
+#define __DISKPARTITIONEDHASHSET_HPP__
+
+#include "HashSetAlgorithms.hpp"
+#include "HashTable.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace specialized_datatypes
+{
+
+namespace detail
+{
+
+// Spreads entropy of a hash over all the bits: top bits select partition, the whole value the bucket.
+[[nodiscard]]
+constexpr uint64_t mix_hash (uint64_t hash) noexcept
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+}
+
+// Set larger than memory, split by hash prefix into 2^partition_bits partitions stored on disk.
+//
+// Each partition is an open addressing table file (header and bucket image with empty sentinels)
+// plus an append only log of inserts not merged yet. Partitions are loaded into memory as
+// open_addressing_hash_set on demand; least recently used ones are written back and dropped
+// when resident tables exceed the memory budget. Inserts into non resident partitions may be
+// buffered per partition and appended to the log sequentially, lookups may be batched so that
+// every partition is visited once per batch.
+//
+// T must be trivially copyable, Predicate must provide empty_type, HashFunction maps a value
+// to a full width hash (not to a bucket).
+template < typename T, typename HashFunction, typename Predicate>
+class disk_partitioned_hash_set
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Partitions are stored as raw images of values");
+
+    // Bucket of a value inside a partition table of given size.
+    struct partition_hasher
+    {
+        [[nodiscard]]
+        size_t operator () (T const & value) const noexcept
+        {
+            return detail::mix_hash(i_hash_function(value)) % i_size;
+        }
+
+        [[nodiscard]]
+        size_t size () const noexcept
+        {
+            return i_size;
+        }
+
+        HashFunction    i_hash_function;
+        size_t          i_size;
+    };
+
+    using table_type = open_addressing_hash_set<T, partition_hasher, Predicate>;
+
+    struct partition_header
+    {
+        uint64_t    i_magic;
+        uint64_t    i_capacity;
+        uint64_t    i_size;
+        uint64_t    i_value_size;
+        uint64_t    i_partition_bits;
+        uint64_t    i_partition_index;
+    };
+
+    struct partition
+    {
+        std::optional<table_type>   i_table;        // Set while resident
+        std::vector<T>              i_buffer;       // Inserts waiting for the log
+        size_t                      i_capacity;     // Of the table file or the resident table
+        size_t                      i_size;         // Merged values
+        size_t                      i_pending;      // Values in the log, not merged yet
+        uint64_t                    i_last_used;
+        bool                        i_is_dirty;
+    };
+
+public:
+
+    class io_error : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Partition file input/output failed";
+        }
+    };
+
+    class corrupted_partition : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Partition file is not a valid partition of this set";
+        }
+    };
+
+    using value_type            = T;
+    using const_reference       = T const &;
+    using hash_function_type    = HashFunction;
+    using predicate_type        = Predicate;
+    using empty_type            = typename predicate_type::empty_type;
+
+    // Partitions already present in the directory are picked up, so a set can be reopened.
+    disk_partitioned_hash_set   (   std::filesystem::path   directory
+                                ,   size_t                  partition_bits
+                                ,   size_t                  memory_budget
+                                ,   hash_function_type      hasher                      = hash_function_type()
+                                ,   predicate_type          predicator                  = predicate_type()
+                                ,   size_t                  initial_partition_capacity  = 1024
+                                ,   size_t                  buffer_limit                = 4096
+                                )
+    :   i_directory         (std::move(directory))
+    ,   i_partition_bits    (partition_bits)
+    ,   i_memory_budget     (memory_budget)
+    ,   i_hash_function     (hasher)
+    ,   i_predicate         (predicator)
+    ,   i_buffer_limit      (std::max<size_t>(buffer_limit, 1))
+    ,   i_partitions        (size_t{1} << partition_bits)
+    ,   i_resident_memory   ()
+    ,   i_tick              ()
+    {
+        std::filesystem::create_directories(i_directory);
+
+        for (size_t index = 0; index < i_partitions.size(); ++index)
+        {
+            auto & part = i_partitions[index];
+            part.i_capacity = std::max<size_t>(initial_partition_capacity, 2);
+            part.i_size     = 0;
+            part.i_pending  = 0;
+            part.i_is_dirty = false;
+
+            if (std::ifstream file{table_path(index), std::ios::binary})
+            {
+                auto const header   = read_header(file, index);
+                part.i_capacity     = header.i_capacity;
+                part.i_size         = header.i_size;
+            }
+
+            std::error_code error;
+            auto const log_size = std::filesystem::file_size(log_path(index), error);
+            if (!error) part.i_pending = log_size / sizeof(value_type);
+        }
+    }
+
+    disk_partitioned_hash_set               (disk_partitioned_hash_set const &) = delete;
+    disk_partitioned_hash_set & operator =  (disk_partitioned_hash_set const &) = delete;
+
+    ~disk_partitioned_hash_set  ()
+    {
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    // Exact insertion: loads the partition if needed. Returns true if the value was inserted.
+    bool emplace                (const_reference value)
+    {
+        if (predicate()(value, s_empty_value)) return false;
+
+        auto const index = partition_of(value);
+        make_resident(index);
+
+        return insert_resident(index, value);
+    }
+
+    // Insertion without reading the partition: resident partitions take the value at once,
+    // others buffer it and append buffers to the partition log once buffer_limit is reached.
+    void insert_buffered        (const_reference value)
+    {
+        if (predicate()(value, s_empty_value)) return;
+
+        auto const index    = partition_of(value);
+        auto & part         = i_partitions[index];
+
+        if (part.i_table)
+        {
+            insert_resident(index, value);
+            return;
+        }
+
+        part.i_buffer.push_back(value);
+        if (part.i_buffer.size() >= i_buffer_limit) flush_buffer(index);
+    }
+
+    [[nodiscard]]
+    bool contains               (const_reference value)
+    {
+        if (predicate()(value, s_empty_value)) return false;
+
+        auto const index    = partition_of(value);
+        auto const & table  = make_resident(index);
+
+        return table.find(value) != table.end();
+    }
+
+    // Sets bit i of out_bitmap iff keys[i] is in the set, with the bit layout of semi_join.
+    // Keys are grouped by partition, every partition is loaded at most once per batch.
+    // Returns number of found keys, throws bitmap_too_small if out_bitmap is shorter than keys.
+    size_t contains_batch       (   std::span<value_type const> keys
+                                ,   std::span<uint64_t>         out_bitmap
+                                )
+    {
+        detail::check_bitmap_size(out_bitmap, keys.size());
+
+        // Counting sort of key indexes by partition.
+        std::vector<size_t> offsets(i_partitions.size() + 1, 0);
+        for (auto const & key : keys) ++offsets[partition_of(key) + 1];
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<size_t> order(keys.size());
+        auto positions = offsets;
+        for (size_t i = 0; i < keys.size(); ++i) order[positions[partition_of(keys[i])]++] = i;
+
+        size_t found = 0;
+        for (size_t index = 0; index < i_partitions.size(); ++index)
+        {
+            if (offsets[index] == offsets[index + 1]) continue;
+
+            auto const & table = make_resident(index);
+            for (auto i = offsets[index]; i < offsets[index + 1]; ++i)
+            {
+                auto const key_index = order[i];
+                if (i + 1 < offsets[index + 1]) table.prefetch(keys[order[i + 1]]);
+
+                auto const is_found = table.find(keys[key_index]) != table.end();
+                detail::write_bitmap_bit(out_bitmap, key_index, is_found);
+                found += is_found;
+            }
+        }
+
+        return found;
+    }
+
+    // Writes dirty resident partitions and appends all insert buffers to the logs.
+    void flush                  ()
+    {
+        for (size_t index = 0; index < i_partitions.size(); ++index)
+        {
+            auto & part = i_partitions[index];
+            if (part.i_table && part.i_is_dirty) write_table(index);
+            if (!part.i_buffer.empty()) flush_buffer(index);
+        }
+    }
+
+    // Merges buffered and logged inserts into the partition tables, making size() exact.
+    void compact                ()
+    {
+        for (size_t index = 0; index < i_partitions.size(); ++index)
+        {
+            auto const & part = i_partitions[index];
+            if (part.i_pending || !part.i_buffer.empty()) make_resident(index);
+        }
+    }
+
+    // Values merged into partitions; buffered and logged inserts are counted by pending_count().
+    [[nodiscard]]
+    size_t size                 () const noexcept
+    {
+        size_t result = 0;
+        for (auto const & part : i_partitions) result += part.i_size;
+        return result;
+    }
+
+    // Upper bound of values inserted but not merged yet (duplicates are not detected).
+    [[nodiscard]]
+    size_t pending_count        () const noexcept
+    {
+        size_t result = 0;
+        for (auto const & part : i_partitions) result += part.i_pending + part.i_buffer.size();
+        return result;
+    }
+
+    [[nodiscard]]
+    size_t partitions_count     () const noexcept
+    {
+        return i_partitions.size();
+    }
+
+    [[nodiscard]]
+    size_t resident_count       () const noexcept
+    {
+        return std::count_if(i_partitions.begin(), i_partitions.end(), [](auto const & part) {return part.i_table.has_value();});
+    }
+
+    [[nodiscard]]
+    size_t resident_memory      () const noexcept
+    {
+        return i_resident_memory;
+    }
+
+    [[nodiscard]]
+    hash_function_type const & hasher () const noexcept
+    {
+        return i_hash_function;
+    }
+
+    [[nodiscard]]
+    predicate_type const & predicate  () const noexcept
+    {
+        return i_predicate;
+    }
+
+private:
+
+    [[nodiscard]]
+    size_t partition_of         (const_reference value) const noexcept
+    {
+        if (i_partition_bits == 0) return 0;
+        return detail::mix_hash(hasher()(value)) >> (64 - i_partition_bits);
+    }
+
+    [[nodiscard]]
+    static size_t table_memory  (size_t capacity) noexcept
+    {
+        // Bucket plus its state byte.
+        return capacity * (sizeof(value_type) + 1);
+    }
+
+    table_type const & make_resident (size_t index)
+    {
+        auto & part         = i_partitions[index];
+        part.i_last_used    = ++i_tick;
+
+        if (!part.i_table)
+        {
+            load_table(index);
+            enforce_budget(index);
+        }
+
+        return *part.i_table;
+    }
+
+    // Reads table file, replays the log and the buffer on top of it.
+    void load_table             (size_t index)
+    {
+        auto & part = i_partitions[index];
+        table_type table(part.i_capacity, partition_hasher{i_hash_function, part.i_capacity});
+
+        if (std::ifstream file{table_path(index), std::ios::binary})
+        {
+            auto const header = read_header(file, index);
+            std::vector<value_type> image(header.i_capacity);
+            if (!file.read(reinterpret_cast<char *>(image.data()), image.size() * sizeof(value_type))) throw corrupted_partition();
+
+            for (auto const & value : image)
+            {
+                if (!predicate()(value, s_empty_value)) table.emplace(value_type(value));
+            }
+        }
+
+        part.i_table        = std::move(table);
+        i_resident_memory   += table_memory(part.i_capacity);
+
+        if (part.i_pending)
+        {
+            std::ifstream log{log_path(index), std::ios::binary};
+            std::vector<value_type> values(part.i_pending);
+            if (!log.read(reinterpret_cast<char *>(values.data()), values.size() * sizeof(value_type))) throw io_error();
+
+            for (auto const & value : values) insert_resident(index, value);
+
+            // The log is removed once the merged table is written.
+            part.i_pending  = 0;
+            part.i_is_dirty = true;
+        }
+
+        for (auto const & value : part.i_buffer) insert_resident(index, value);
+        part.i_buffer.clear();
+        part.i_buffer.shrink_to_fit();
+
+        part.i_size = part.i_table->size();
+    }
+
+    // Growing partition may push resident tables over the budget, other partitions are dropped then.
+    bool insert_resident        (size_t index, const_reference value)
+    {
+        auto & part     = i_partitions[index];
+        auto & table    = *part.i_table;
+
+        if (4 * (table.size() + 1) > 3 * table.capacity())
+        {
+            auto const capacity = 2 * table.capacity();
+            table.rebalance(capacity, partition_hasher{i_hash_function, capacity});
+
+            i_resident_memory   += table_memory(capacity) - table_memory(part.i_capacity);
+            part.i_capacity     = capacity;
+
+            enforce_budget(index);
+        }
+
+        auto const is_inserted = table.emplace(value_type(value));
+        if (is_inserted)
+        {
+            part.i_is_dirty = true;
+            part.i_size     = table.size();
+        }
+
+        return is_inserted;
+    }
+
+    // Drops least recently used resident partitions (but the one in use) while over budget.
+    void enforce_budget         (size_t index_in_use)
+    {
+        while (i_resident_memory > i_memory_budget)
+        {
+            auto victim = i_partitions.size();
+            for (size_t index = 0; index < i_partitions.size(); ++index)
+            {
+                auto const & part = i_partitions[index];
+                if (    index != index_in_use
+                    &&  part.i_table
+                    &&  (victim == i_partitions.size() || part.i_last_used < i_partitions[victim].i_last_used)
+                   )
+                {
+                    victim = index;
+                }
+            }
+
+            if (victim == i_partitions.size()) break;
+
+            evict(victim);
+        }
+    }
+
+    void evict                  (size_t index)
+    {
+        auto & part = i_partitions[index];
+
+        if (part.i_is_dirty) write_table(index);
+
+        part.i_table.reset();
+        i_resident_memory -= table_memory(part.i_capacity);
+    }
+
+    // Lays the resident values out as an open addressing bucket image and writes it.
+    void write_table            (size_t index)
+    {
+        auto & part             = i_partitions[index];
+        auto const & table      = *part.i_table;
+        auto const capacity     = table.capacity();
+        partition_hasher const bucket_of {i_hash_function, capacity};
+
+        std::vector<value_type> image(capacity, value_type(s_empty_value));
+        for (auto const & value : table)
+        {
+            auto position = bucket_of(value);
+            while (!predicate()(image[position], s_empty_value)) position = (position + 1) % capacity;
+            image[position] = value;
+        }
+
+        partition_header const header {s_magic, capacity, table.size(), sizeof(value_type), i_partition_bits, index};
+
+        auto const path     = table_path(index);
+        auto temporary_path = path;
+        temporary_path     += ".tmp";
+        {
+            std::ofstream file{temporary_path, std::ios::binary | std::ios::trunc};
+            file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+            file.write(reinterpret_cast<char const *>(image.data()), image.size() * sizeof(value_type));
+            if (!file) throw io_error();
+        }
+        std::filesystem::rename(temporary_path, path);
+        std::filesystem::remove(log_path(index));
+
+        part.i_is_dirty = false;
+    }
+
+    void flush_buffer           (size_t index)
+    {
+        auto & part = i_partitions[index];
+
+        std::ofstream log{log_path(index), std::ios::binary | std::ios::app};
+        log.write(reinterpret_cast<char const *>(part.i_buffer.data()), part.i_buffer.size() * sizeof(value_type));
+        if (!log) throw io_error();
+
+        part.i_pending += part.i_buffer.size();
+        part.i_buffer.clear();
+    }
+
+    // Files of another partitioning would route keys to wrong partitions, so they are rejected.
+    [[nodiscard]]
+    partition_header read_header        (std::ifstream & file, size_t index) const
+    {
+        partition_header header {};
+        if (    !file.read(reinterpret_cast<char *>(&header), sizeof(header))
+            ||  header.i_magic != s_magic
+            ||  header.i_value_size != sizeof(value_type)
+            ||  header.i_capacity == 0
+            ||  header.i_partition_bits != i_partition_bits
+            ||  header.i_partition_index != index
+           )
+        {
+            throw corrupted_partition();
+        }
+
+        return header;
+    }
+
+    [[nodiscard]]
+    std::filesystem::path table_path    (size_t index) const
+    {
+        return i_directory / ("partition_" + std::to_string(index) + ".table");
+    }
+
+    [[nodiscard]]
+    std::filesystem::path log_path      (size_t index) const
+    {
+        return i_directory / ("partition_" + std::to_string(index) + ".log");
+    }
+
+    std::filesystem::path   i_directory;
+    size_t                  i_partition_bits;
+    size_t                  i_memory_budget;
+    hash_function_type      i_hash_function;
+    predicate_type          i_predicate;
+    size_t                  i_buffer_limit;
+
+    std::vector<partition>  i_partitions;
+    size_t                  i_resident_memory;
+    uint64_t                i_tick;
+
+    constexpr static empty_type s_empty_value   {};
+    constexpr static uint64_t   s_magic         = 0x4F41485350415254ull;
+};
+
+}
+
+#endif // __DISKPARTITIONEDHASHSET_HPP__
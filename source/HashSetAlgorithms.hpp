@@ -0,0 +1,180 @@
+#ifndef __HASHSETALGORITHMS_HPP__
+#define __HASHSETALGORITHMS_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+namespace specialized_datatypes
+{
+
+// Number of probes issued (prefetched) ahead of the lookups consuming them.
+constexpr size_t s_probe_batch_size = 16;
+
+class bitmap_too_small : public std::exception
+{
+public:
+    const char * what () const noexcept override
+    {
+        return "Output bitmap must hold a bit per probed key";
+    }
+};
+
+namespace detail
+{
+
+constexpr size_t s_bitmap_word_bits = 64;
+
+// Bitmap outputs hold bit i in word i / 64 at position i % 64.
+constexpr void check_bitmap_size    (   std::span<uint64_t const>   bitmap
+                                    ,   size_t                      bits_count
+                                    )
+{
+    if (bitmap.size() * s_bitmap_word_bits < bits_count) throw bitmap_too_small();
+}
+
+constexpr void write_bitmap_bit     (   std::span<uint64_t>         bitmap
+                                    ,   size_t                      index
+                                    ,   bool                        is_set
+                                    ) noexcept
+{
+    auto & word     = bitmap[index / s_bitmap_word_bits];
+    auto const bit  = uint64_t{1} << (index % s_bitmap_word_bits);
+
+    if (is_set) word |= bit;
+    else        word &= ~bit;
+}
+
+// Looks up every element of [first, last) in the table in batches: buckets of the whole
+// batch are prefetched first, then probed in order. Calls visit(element, is_found) in input order.
+template <typename HashSetT, typename InputIt, typename VisitorT>
+constexpr void probe_batched    (   HashSetT const &    table
+                                ,   InputIt             first
+                                ,   InputIt             last
+                                ,   VisitorT &&         visit
+                                )
+{
+    using element_type = std::remove_reference_t<decltype(*first)>;
+
+    std::array<element_type *, s_probe_batch_size> batch;
+
+    while (first != last)
+    {
+        size_t count = 0;
+        for (; count < batch.size() && first != last; ++count, ++first)
+        {
+            batch[count] = std::addressof(*first);
+            table.prefetch(*batch[count]);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            visit(*batch[i], table.find(*batch[i]) != table.end());
+        }
+    }
+}
+
+template <typename HashSetT>
+constexpr size_t probe_to_bitmap    (   HashSetT const &                                        table
+                                    ,   std::span<typename HashSetT::value_type const>          keys
+                                    ,   std::span<uint64_t>                                     out_bitmap
+                                    ,   bool                                                    expected
+                                    )
+{
+    check_bitmap_size(out_bitmap, keys.size());
+
+    size_t index    = 0;
+    size_t matched  = 0;
+    probe_batched   (   table, keys.begin(), keys.end()
+                    ,   [&index, &matched, out_bitmap, expected](auto const &, bool is_found)
+                        {
+                            write_bitmap_bit(out_bitmap, index++, is_found == expected);
+                            matched += is_found == expected;
+                        }
+                    );
+
+    return matched;
+}
+
+}
+
+// Writes elements present in both tables to out. Iterates the smaller table, probes the bigger one.
+template <typename HashSetT, typename OutputIt>
+constexpr OutputIt intersect    (   HashSetT const &    first
+                                ,   HashSetT const &    second
+                                ,   OutputIt            out
+                                )
+{
+    auto const & iterated   = first.size() <= second.size() ? first : second;
+    auto const & probed     = first.size() <= second.size() ? second : first;
+
+    detail::probe_batched   (   probed, iterated.begin(), iterated.end()
+                            ,   [&out](auto const & value, bool is_found)
+                                {
+                                    if (is_found) *out++ = value;
+                                }
+                            );
+
+    return out;
+}
+
+// Writes elements of first which are missing in second to out.
+template <typename HashSetT, typename OutputIt>
+constexpr OutputIt difference   (   HashSetT const &    first
+                                ,   HashSetT const &    second
+                                ,   OutputIt            out
+                                )
+{
+    detail::probe_batched   (   second, first.begin(), first.end()
+                            ,   [&out](auto const & value, bool is_found)
+                                {
+                                    if (!is_found) *out++ = value;
+                                }
+                            );
+
+    return out;
+}
+
+// Writes every element of either table to out exactly once: the bigger table as is,
+// then elements of the smaller one missing in the bigger one.
+template <typename HashSetT, typename OutputIt>
+constexpr OutputIt unite        (   HashSetT const &    first
+                                ,   HashSetT const &    second
+                                ,   OutputIt            out
+                                )
+{
+    auto const & iterated   = first.size() <= second.size() ? first : second;
+    auto const & probed     = first.size() <= second.size() ? second : first;
+
+    for (auto const & value : probed) *out++ = value;
+
+    return difference(iterated, probed, out);
+}
+
+// Sets bit i of out_bitmap iff keys[i] is in the table. Returns number of set bits.
+template <typename HashSetT>
+constexpr size_t semi_join      (   HashSetT const &                                table
+                                ,   std::span<typename HashSetT::value_type const>  keys
+                                ,   std::span<uint64_t>                             out_bitmap
+                                )
+{
+    return detail::probe_to_bitmap(table, keys, out_bitmap, true);
+}
+
+// Sets bit i of out_bitmap iff keys[i] is not in the table. Returns number of set bits.
+template <typename HashSetT>
+constexpr size_t anti_join      (   HashSetT const &                                table
+                                ,   std::span<typename HashSetT::value_type const>  keys
+                                ,   std::span<uint64_t>                             out_bitmap
+                                )
+{
+    return detail::probe_to_bitmap(table, keys, out_bitmap, false);
+}
+
+}
+
+#endif // __HASHSETALGORITHMS_HPP__
@@ -1,22 +1,134 @@
 #ifndef __HASHTABLE_HPP__
 #define __HASHTABLE_HPP__
 
-#include <iterator>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
 #include <exception>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace specialized_datatypes
 {
 
-template < typename T, typename HashFunction, typename Predicate>
+namespace detail
+{
+
+// Sentinel types are optional: predicates of keys without spare values (e.g. move only handles)
+// do not provide them.
+template <typename PredicateT>
+struct empty_type_of
+{
+    using type = void;
+};
+
+template <typename PredicateT>
+requires requires { typename PredicateT::empty_type; }
+struct empty_type_of<PredicateT>
+{
+    using type = typename PredicateT::empty_type;
+};
+
+template <typename PredicateT>
+struct erased_type_of
+{
+    using type = void;
+};
+
+template <typename PredicateT>
+requires requires { typename PredicateT::erased_type; }
+struct erased_type_of<PredicateT>
+{
+    using type = typename PredicateT::erased_type;
+};
+
+// Lookup by a key other than the stored value (e.g. the key part of a map entry), enabled when both
+// the hasher and the predicate declare is_transparent and accept such keys next to values.
+template <typename HashFunctionT, typename PredicateT>
+concept transparent_lookup = requires
+{
+    typename HashFunctionT::is_transparent;
+    typename PredicateT::is_transparent;
+};
+
+struct no_timestamps
+{
+};
+
+struct no_references
+{
+};
+
+template <typename EvictionPolicyT>
+struct timestamps_of
+{
+    using type = no_timestamps;
+};
+
+template <typename EvictionPolicyT>
+requires requires { typename EvictionPolicyT::clock_type; }
+struct timestamps_of<EvictionPolicyT>
+{
+    using type = std::vector<typename EvictionPolicyT::clock_type::time_point>;
+};
+
+}
+
+// Default policy: emplace throws table_is_full when no free bucket is left.
+struct no_eviction
+{
+};
+
+// Bounded cache mode: at most max_size entries are kept (three quarters of the capacity if 0,
+// never more than seven eighths, so that erased buckets have proportional headroom).
+// Inserting a new value into a full cache evicts an entry chosen by CLOCK (second chance):
+// find and repeated emplace mark an entry referenced, the clock hand clears the mark once
+// and evicts the first unmarked entry it meets.
+struct clock_eviction
+{
+    size_t max_size = 0;
+};
+
+// clock_eviction with entries expiring time_to_live after insertion. Expired entries are not
+// found, are evicted regardless of the mark and are replaced by emplace of an equal value.
+template <typename Clock = std::chrono::steady_clock>
+struct clock_ttl_eviction
+{
+    using clock_type = Clock;
+
+    size_t                          max_size        = 0;
+    typename clock_type::duration   time_to_live    = clock_type::duration::max();
+};
+
+template < typename T, typename HashFunction, typename Predicate, typename EvictionPolicy = no_eviction>
 class open_addressing_hash_set
 {
-    using container_type            = std::vector<T>;
-    using self_type                 = open_addressing_hash_set<T, HashFunction, Predicate>;
+    using allocator_type            = std::allocator<T>;
+    using allocator_traits          = std::allocator_traits<allocator_type>;
+    using self_type                 = open_addressing_hash_set<T, HashFunction, Predicate, EvictionPolicy>;
+
+    enum class bucket_state : uint8_t
+    {
+        empty,
+        occupied,
+        erased
+    };
 
-    using container_iterator        = typename container_type::iterator;
-    using const_container_iterator  = typename container_type::const_iterator;
+    constexpr static bool s_is_evicting = !std::is_same_v<EvictionPolicy, no_eviction>;
 
+    using state_container_type      = std::vector<bucket_state>;
+    using timestamp_container_type  = typename detail::timestamps_of<EvictionPolicy>::type;
+    // CLOCK marks, used in eviction modes only.
+    using reference_container_type  = std::conditional_t<s_is_evicting, std::vector<uint8_t>, detail::no_references>;
+
+    constexpr static bool s_is_expiring = !std::is_same_v<timestamp_container_type, detail::no_timestamps>;
 
 public:
 
@@ -45,33 +157,35 @@ public:
     using const_reference       = T const &;
     using hash_function_type    = HashFunction;
     using predicate_type        = Predicate;
-    using empty_type            = typename predicate_type::empty_type;
-    using erased_type           = typename predicate_type::erased_type;
+    using eviction_policy_type  = EvictionPolicy;
+    using empty_type            = typename detail::empty_type_of<predicate_type>::type;
+    using erased_type           = typename detail::erased_type_of<predicate_type>::type;
 
     class const_iterator
     {
     public:
 
         using iterator_category = std::bidirectional_iterator_tag;
-        using value_type        = typename const_container_iterator::value_type;
-        using difference_type   = typename const_container_iterator::difference_type;
-        using pointer           = typename const_container_iterator::pointer;
-        using reference         = typename const_container_iterator::reference;
+        using value_type        = typename open_addressing_hash_set::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = typename open_addressing_hash_set::const_pointer;
+        using reference         = typename open_addressing_hash_set::const_reference;
 
         constexpr pointer operator -> () const noexcept
         {
-            return i_iterator.operator-> ();
+            return i_hash_table->i_values + i_position;
         }
 
         constexpr reference operator * () const noexcept
         {
-            return *i_iterator;
+            return i_hash_table->i_values[i_position];
         }
 
         constexpr const_iterator & operator++ () noexcept
         {
-            while   (   i_iterator < i_hash_table->i_container.end()
-                    &&  i_hash_table->is_available_bucket(++i_iterator)
+            auto const count_limit = i_hash_table->capacity();
+            while   (   i_position < count_limit
+                    &&  i_hash_table->is_available_bucket(++i_position)
                     );
 
             return *this;
@@ -86,19 +200,19 @@ public:
 
         constexpr const_iterator & operator-- () noexcept
         {
-            while   (   i_iterator >= i_hash_table->i_container.begin()
-                    &&  i_hash_table->is_available_bucket(--i_iterator)
-                    );
-
-            if (i_iterator < i_hash_table->i_container.begin())
+            auto const count_limit = i_hash_table->capacity();
+            do
             {
-                i_iterator = i_hash_table->i_container.end();
+                i_position = i_position == 0 ? count_limit : i_position - 1;
             }
+            while   (   i_position < count_limit
+                    &&  i_hash_table->is_available_bucket(i_position)
+                    );
 
             return *this;
         }
 
-        constexpr const_iterator & operator-- (int) noexcept
+        constexpr const_iterator operator-- (int) noexcept
         {
             auto current = *this;
             --(*this);
@@ -107,7 +221,7 @@ public:
 
         constexpr bool operator == (const_iterator const & it) const noexcept
         {
-            return i_iterator == it.i_iterator;
+            return i_position == it.i_position;
         }
 
         constexpr bool operator != (const_iterator const & it) const noexcept
@@ -116,91 +230,308 @@ public:
         }
 
     private:
-        constexpr const_iterator    (   open_addressing_hash_set const * htable
-                                    ,   const_container_iterator it
+        constexpr const_iterator    (   open_addressing_hash_set const *    htable
+                                    ,   size_t                              position
                                     ) noexcept
         : i_hash_table  (htable)
-        , i_iterator    (it)
+        , i_position    (position)
         {}
 
         friend open_addressing_hash_set;
 
     private:
         open_addressing_hash_set const *    i_hash_table;
-        const_container_iterator            i_iterator;
+        size_t                              i_position;
     };
 
-    constexpr explicit open_addressing_hash_set (   size_t              reserve_count
-                                                ,   hash_function_type  hasher      = hash_function_type()
-                                                ,   predicate_type      predicator  = predicate_type()
+    // Owns an element taken out of a table, lets it move between tables without copies.
+    class node_type
+    {
+    public:
+
+        constexpr node_type         () noexcept = default;
+
+        // Moved from node is empty, as for standard node handles.
+        constexpr node_type         (node_type && other) noexcept(std::is_nothrow_move_constructible_v<value_type>)
+        : i_value   (std::move(other.i_value))
+        {
+            other.i_value.reset();
+        }
+
+        constexpr node_type & operator = (node_type && other) noexcept(std::is_nothrow_move_constructible_v<value_type>)
+        {
+            if (this != &other)
+            {
+                i_value = std::move(other.i_value);
+                other.i_value.reset();
+            }
+
+            return *this;
+        }
+
+        [[nodiscard]]
+        constexpr bool empty                    () const noexcept
+        {
+            return !i_value.has_value();
+        }
+
+        constexpr explicit operator bool        () const noexcept
+        {
+            return !empty();
+        }
+
+        [[nodiscard]]
+        constexpr reference value               () noexcept
+        {
+            return *i_value;
+        }
+
+        [[nodiscard]]
+        constexpr const_reference value         () const noexcept
+        {
+            return *i_value;
+        }
+
+    private:
+        constexpr explicit node_type (value_type && value)
+        : i_value   (std::move(value))
+        {
+        }
+
+        friend open_addressing_hash_set;
+
+    private:
+        std::optional<value_type> i_value;
+    };
+
+    constexpr explicit open_addressing_hash_set (   size_t                  reserve_count
+                                                ,   hash_function_type      hasher      = hash_function_type()
+                                                ,   predicate_type          predicator  = predicate_type()
+                                                ,   eviction_policy_type    eviction    = eviction_policy_type()
                                                 )
-    :   i_container     (reserve_count, s_empty_value)
-    ,   i_hash_function (hasher)
-    ,   i_predicate     (predicator)
-    ,   i_occupancy     ()
+    :   i_values            (allocate(reserve_count))
+    ,   i_states            (reserve_count, bucket_state::empty)
+    ,   i_timestamps        (make_timestamps(reserve_count))
+    ,   i_references        (make_references(reserve_count))
+    ,   i_hash_function     (hasher)
+    ,   i_predicate         (predicator)
+    ,   i_eviction_policy   (eviction)
+    ,   i_occupancy         ()
+    ,   i_erased            ()
+    ,   i_clock_hand        ()
     {
     }
 
-    constexpr bool emplace                      (value_type && value)
+    constexpr open_addressing_hash_set          (self_type const & other)
+    requires std::copy_constructible<value_type>
+    :   i_values            (allocate(other.capacity()))
+    ,   i_states            (other.capacity(), bucket_state::empty)
+    ,   i_timestamps        (other.i_timestamps)
+    ,   i_references        (make_references(other.capacity()))
+    ,   i_hash_function     (other.i_hash_function)
+    ,   i_predicate         (other.i_predicate)
+    ,   i_eviction_policy   (other.i_eviction_policy)
+    ,   i_occupancy         ()
+    ,   i_erased            (other.i_erased)
+    ,   i_clock_hand        (other.i_clock_hand)
     {
-        if (value == s_empty_value) return false;
+        for (size_t position = 0; position < capacity(); ++position)
+        {
+            if (!other.is_available_bucket(position))
+            {
+                occupy_bucket(position, other.i_values[position]);
+            }
+            i_states[position] = other.i_states[position];
+            if constexpr (s_is_evicting) i_references[position] = other.load_reference(position);
+        }
+    }
 
-        auto it = find_position(value);
+    constexpr open_addressing_hash_set          (self_type && other) noexcept
+    :   i_values            (std::exchange(other.i_values, nullptr))
+    ,   i_states            (std::move(other.i_states))
+    ,   i_timestamps        (std::move(other.i_timestamps))
+    ,   i_references        (std::move(other.i_references))
+    ,   i_hash_function     (std::move(other.i_hash_function))
+    ,   i_predicate         (std::move(other.i_predicate))
+    ,   i_eviction_policy   (std::move(other.i_eviction_policy))
+    ,   i_occupancy         (std::exchange(other.i_occupancy, 0))
+    ,   i_erased            (std::exchange(other.i_erased, 0))
+    ,   i_clock_hand        (std::exchange(other.i_clock_hand, 0))
+    {
+        other.i_states.clear();
+        other.i_timestamps = make_timestamps(0);
+        other.i_references = make_references(0);
+    }
 
-        if (it == i_container.end()) throw table_is_full();
+    constexpr self_type & operator =            (self_type const & other)
+    requires std::copy_constructible<value_type>
+    {
+        if (this != &other)
+        {
+            self_type copy(other);
+            swap(copy);
+        }
 
-        auto result = false;
+        return *this;
+    }
 
-        if (is_available_bucket(it))
+    constexpr self_type & operator =            (self_type && other) noexcept
+    {
+        if (this != &other)
         {
-            *it = std::move(value);
-            ++i_occupancy;
-            result = true;
+            self_type moved(std::move(other));
+            swap(moved);
         }
 
-        return result;
+        return *this;
+    }
 
+    constexpr ~open_addressing_hash_set         ()
+    {
+        release();
+    }
+
+    constexpr void swap                         (self_type & other) noexcept
+    {
+        using std::swap;
+        swap(i_values,          other.i_values);
+        swap(i_states,          other.i_states);
+        swap(i_timestamps,      other.i_timestamps);
+        swap(i_references,      other.i_references);
+        swap(i_hash_function,   other.i_hash_function);
+        swap(i_predicate,       other.i_predicate);
+        swap(i_eviction_policy, other.i_eviction_policy);
+        swap(i_occupancy,       other.i_occupancy);
+        swap(i_erased,          other.i_erased);
+        swap(i_clock_hand,      other.i_clock_hand);
+    }
+
+    // The value is moved into the table only when inserted, otherwise it is left intact.
+    // In eviction modes inserting into a full table evicts an entry instead of throwing.
+    constexpr bool emplace                      (value_type && value)
+    {
+        return try_emplace(value, std::move(value)).second;
     }
 
     template <typename... Args>
     constexpr bool emplace                      (Args &&... args)
     {
-        return emplace(value_type(args...));
+        return emplace(value_type(std::forward<Args>(args)...));
     }
 
-    constexpr size_t erase                      (const_reference value)
+    // Inserts value_type(args...) unless a value equal to key is present, as emplace does, and
+    // returns the bucket of the key as well (end() for rejected keys). The value is constructed
+    // once the key was looked up, so args may refer to the key or move from it.
+    template <typename K, typename... Args>
+    constexpr std::pair<const_iterator, bool> try_emplace (K const & key, Args &&... args)
+    requires std::same_as<K, value_type> || detail::transparent_lookup<HashFunction, Predicate>
     {
-        auto it = find_position(value);
-        size_t result = 0;
+        if (is_rejected_value(key)) return {end(), false};
 
-        if (it != i_container.end() && !is_available_bucket(it))
+        auto [position, is_found] = find_insert_position(key);
+
+        if (is_found)
         {
-            *it     = std::move(s_erased_value);
-            result  = 1;
-            --i_occupancy;
+            if (!is_expired(position))
+            {
+                mark_referenced(position);
+                return {const_iterator(this, position), false};
+            }
+
+            std::destroy_at(i_values + position);
+            std::construct_at(i_values + position, std::forward<Args>(args)...);
+            if constexpr (s_is_evicting) i_references[position] = 0;
+            stamp(position);
+
+            return {const_iterator(this, position), true};
         }
 
-        auto const first        = i_container.begin();
-        auto erased_position    = std::distance(first, it);
-        auto const count_limit  = i_container.size();
-        auto step               = 1;
-        auto it_following       = first + (erased_position + 1) % count_limit; 
-        while   (   result
-                &&  step < count_limit
-                &&  predicate()(*it, s_erased_value)
-                &&  predicate()(*it_following, s_empty_value)
-                )
+        if constexpr (s_is_evicting)
         {
-            *it = std::move(s_empty_value);
-            --erased_position;
-            ++step;
-            it  = first + erased_position % count_limit;
-            it  = first + (erased_position + 1) % count_limit;
+            auto const is_evicted = i_occupancy >= max_size() && evict();
+            auto const is_purged  = i_erased > (capacity() - max_size()) / 2;
+
+            // Erased buckets consumed half of the headroom, rehash in place drops them. Every
+            // insert adds at most one erased bucket, so the rehash is amortized over
+            // a proportional share of the capacity.
+            if (is_purged) rebalance(capacity());
+
+            if (is_evicted || is_purged) position = find_insert_position(key).first;
         }
 
+        if (position == capacity()) throw table_is_full();
+
+        occupy_bucket(position, std::forward<Args>(args)...);
+        stamp(position);
+
+        return {const_iterator(this, position), true};
+    }
+
+    // Inserts value owned by the node, node is emptied on success only.
+    constexpr bool insert                       (node_type && node)
+    {
+        if (node.empty()) return false;
+
+        auto const result = emplace(std::move(node.value()));
+        if (result) node.i_value.reset();
+
         return result;
     }
 
+    constexpr size_t erase                      (const_reference value)
+    {
+        auto const position = find_position(value);
+
+        if (position == capacity()) return 0;
+
+        std::destroy_at(i_values + position);
+        release_bucket(position);
+
+        return 1;
+    }
+
+    // Erases the element at position (not end()), returns iterator to the following one.
+    constexpr const_iterator erase              (const_iterator position)
+    {
+        std::destroy_at(i_values + position.i_position);
+        release_bucket(position.i_position);
+
+        return ++position;
+    }
+
+    [[nodiscard]]
+    constexpr node_type extract                 (const_iterator position)
+    {
+        if (position == end()) return node_type();
+
+        node_type node(std::move(i_values[position.i_position]));
+        std::destroy_at(i_values + position.i_position);
+        release_bucket(position.i_position);
+
+        return node;
+    }
+
+    [[nodiscard]]
+    constexpr node_type extract                 (const_reference value)
+    {
+        return extract(find(value));
+    }
+
+    // Destroys every element, capacity is kept.
+    constexpr void clear                        () noexcept
+    {
+        for (size_t position = 0; position < capacity(); ++position)
+        {
+            if (is_occupied_state(i_states[position])) std::destroy_at(i_values + position);
+        }
+
+        std::fill(i_states.begin(), i_states.end(), bucket_state::empty);
+        if constexpr (s_is_evicting) std::fill(i_references.begin(), i_references.end(), 0);
+        i_occupancy     = 0;
+        i_erased        = 0;
+        i_clock_hand    = 0;
+    }
+
     template<typename HasherT>
     constexpr void rebalance                    (   size_t reserve_count
                                                 ,   HasherT && rebalance_hasher
@@ -218,52 +549,103 @@ public:
             i_hash_function = std::move(current_hasher);
             throw;
         }
-        
+
     }
 
+    // Elements are moved into the new buckets, never copied. CLOCK marks and timestamps are kept.
     constexpr void rebalance                    (size_t reserve_count)
-    {        
+    {
         if (reserve_count < size()) throw rebalancing_size_too_small();
 
-        container_type original (reserve_count, s_empty_value);
-        std::swap(i_container, original);
-        i_occupancy = 0;
-        
-        for (auto & value : original)
+        auto original_values                    = std::exchange(i_values, allocate(reserve_count));
+        state_container_type original           (reserve_count, bucket_state::empty);
+        timestamp_container_type timestamps     = make_timestamps(reserve_count);
+        reference_container_type references     = make_references(reserve_count);
+        std::swap(i_states, original);
+        std::swap(i_timestamps, timestamps);
+        std::swap(i_references, references);
+        i_occupancy     = 0;
+        i_erased        = 0;
+        // The hand keeps its relative place, restarting from 0 would evict one area over and over.
+        i_clock_hand    = original.empty() ? 0 : i_clock_hand * reserve_count / original.size();
+
+        for (size_t position = 0; position < original.size(); ++position)
         {
-            if (!is_available_bucket_value(value))
+            if (is_occupied_state(original[position]))
             {
-                emplace(std::move(value));
-                value = s_empty_value;
+                auto const rebalanced = find_insert_position(original_values[position]).first;
+                if (rebalanced == capacity()) throw table_is_full();
+
+                occupy_bucket(rebalanced, std::move(original_values[position]));
+                std::destroy_at(original_values + position);
+
+                if constexpr (s_is_evicting) i_references[rebalanced] = references[position];
+                if constexpr (s_is_expiring) i_timestamps[rebalanced] = timestamps[position];
             }
         }
+
+        deallocate(original_values, original.size());
     }
 
+    // In eviction modes a found entry gets its CLOCK mark set. The mark is a relaxed atomic store
+    // to a separate array, so concurrent const finds (e.g. readers of a shared snapshot) do not race.
     [[nodiscard]]
     constexpr const_iterator find               (const_reference value) const
     {
-        auto it = find_position(value);
+        return find_key(value);
+    }
 
-        if (it != i_container.end() && is_available_bucket(it))
-        {
-            it = i_container.end();
-        }
+    template <typename K>
+    [[nodiscard]]
+    constexpr const_iterator find               (K const & key) const
+    requires detail::transparent_lookup<HashFunction, Predicate>
+    {
+        return find_key(key);
+    }
+
+    // Hints bucket of the value into cache ahead of find / emplace, lets batched probes overlap memory latency.
+    constexpr void prefetch                     (const_reference value) const noexcept
+    {
+        prefetch_key(value);
+    }
 
-        return const_iterator(this, it);        
+    template <typename K>
+    constexpr void prefetch                     (K const & key) const noexcept
+    requires detail::transparent_lookup<HashFunction, Predicate>
+    {
+        prefetch_key(key);
     }
 
     [[nodiscard]]
     constexpr size_t capacity                   () const noexcept
     {
-        return i_container.size();
+        return i_states.size();
     }
 
+    // Includes expired entries not evicted yet.
     [[nodiscard]]
     constexpr size_t size                       () const noexcept
     {
         return i_occupancy;
     }
 
+    // Number of entries kept before eviction starts, capacity() if the table does not evict.
+    // At least one eighth of the buckets (and at least one) is always left free to keep probing short.
+    [[nodiscard]]
+    constexpr size_t max_size                   () const noexcept
+    {
+        if constexpr (s_is_evicting)
+        {
+            auto const limit        = capacity() - std::min(capacity(), std::max<size_t>(1, capacity() / 8));
+            auto const requested    = i_eviction_policy.max_size ? i_eviction_policy.max_size : capacity() * 3 / 4;
+            return std::min(requested, limit);
+        }
+        else
+        {
+            return capacity();
+        }
+    }
+
     [[nodiscard]]
     constexpr bool is_empty                     () const noexcept
     {
@@ -282,17 +664,24 @@ public:
         return i_predicate;
     }
 
+    [[nodiscard]]
+    constexpr eviction_policy_type const & eviction_policy () const noexcept
+    {
+        return i_eviction_policy;
+    }
+
     [[nodiscard]]
     constexpr static empty_type empty_value     () noexcept
+    requires (!std::is_void_v<empty_type>)
     {
-        return s_empty_value;
+        return empty_type{};
     }
 
     [[nodiscard]]
     constexpr const_iterator begin              () const noexcept
     {
-        const_iterator it(this, i_container.begin());
-        if (!i_container.empty() && is_available_bucket(it.i_iterator)) ++it;
+        const_iterator it(this, 0);
+        if (is_available_bucket(0)) ++it;
 
         return it;
     }
@@ -306,7 +695,7 @@ public:
     [[nodiscard]]
     constexpr const_iterator end                () const noexcept
     {
-        return const_iterator(this, i_container.end());
+        return const_iterator(this, capacity());
     }
 
     [[nodiscard]]
@@ -317,60 +706,290 @@ public:
 
 private:
 
+    template <typename K>
+    [[nodiscard]]
+    constexpr const_iterator find_key           (K const & key) const
+    {
+        auto position = find_position(key);
+
+        if (position != capacity())
+        {
+            if (is_expired(position)) position = capacity();
+            else mark_referenced(position);
+        }
+
+        return const_iterator(this, position);
+    }
+
+    template <typename K>
+    constexpr void prefetch_key                 (K const & key) const noexcept
+    {
+        if (std::is_constant_evaluated() || capacity() == 0) return;
+
+        // Probes read the state byte first, its cache line is as much on the critical path as the value.
+        auto const position = hasher()(key) % capacity();
+        __builtin_prefetch(i_states.data() + position);
+        __builtin_prefetch(i_values + position);
+    }
+
+    // Returns bucket holding the value, or capacity() if it is missing.
+    template <typename K>
     [[nodiscard]]
-    constexpr const_container_iterator find_position    (const_reference value) const
+    constexpr size_t find_position              (K const & value) const
     {
-        if (predicate()(value, s_empty_value)) return i_container.end();
+        auto const count_limit = capacity();
+        if (is_rejected_value(value)) return count_limit;
 
-        auto const first                = i_container.begin();
+        auto const expected_position = hasher()(value);
+        for (size_t steps = 0; steps < count_limit; ++steps)
+        {
+            auto const position = (expected_position + steps) % count_limit;
+            if (i_states[position] == bucket_state::empty) break;
+            if (is_occupied_state(i_states[position]) && predicate()(i_values[position], value)) return position;
+        }
+
+        return count_limit;
+    }
+
+    // Returns bucket holding the value and true, or first empty bucket on its probe path and false.
+    // Eviction modes reuse the first erased bucket on the path instead, non evicting tables keep
+    // the original placement. The bucket is capacity() if the table is full.
+    template <typename K>
+    [[nodiscard]]
+    constexpr std::pair<size_t, bool> find_insert_position (K const & value) const
+    {
+        auto const count_limit          = capacity();
         auto const expected_position    = hasher()(value);
-        auto it                         = std::next(first, expected_position);
+        auto first_erased               = count_limit;
+
+        for (size_t steps = 0; steps < count_limit; ++steps)
+        {
+            auto const position = (expected_position + steps) % count_limit;
+            if (i_states[position] == bucket_state::empty) return {first_erased != count_limit ? first_erased : position, false};
+            if (is_occupied_state(i_states[position]) && predicate()(i_values[position], value)) return {position, true};
 
-        auto const count_limit          = i_container.size();
-        size_t steps                    = 0;
-        while   (   steps < count_limit
-                &&  !predicate()(*it, s_empty_value)
-                &&  !predicate()(*it, value)
-                )
+            if constexpr (s_is_evicting)
+            {
+                if (i_states[position] == bucket_state::erased && first_erased == count_limit) first_erased = position;
+            }
+        }
+
+        return {first_erased, false};
+    }
+
+    template <typename... Args>
+    constexpr void occupy_bucket                (size_t position, Args &&... args)
+    {
+        std::construct_at(i_values + position, std::forward<Args>(args)...);
+        if (i_states[position] == bucket_state::erased) --i_erased;
+        i_states[position] = bucket_state::occupied;
+        if constexpr (s_is_evicting) i_references[position] = 0;
+        ++i_occupancy;
+    }
+
+    // Marks bucket of an already destroyed element erased. Erased buckets directly followed
+    // by an empty one end no probe sequence, so they are turned into empty ones.
+    constexpr void release_bucket               (size_t position) noexcept
+    {
+        auto const count_limit = capacity();
+
+        i_states[position] = bucket_state::erased;
+        --i_occupancy;
+        ++i_erased;
+
+        if (i_states[(position + 1) % count_limit] != bucket_state::empty) return;
+
+        for (size_t steps = 0; steps < count_limit && i_states[position] == bucket_state::erased; ++steps)
         {
-            ++steps;
-            it = std::next(first, (expected_position + steps) % count_limit);
+            i_states[position] = bucket_state::empty;
+            --i_erased;
+            position = (position + count_limit - 1) % count_limit;
         }
+    }
 
-        if (steps == count_limit) it = i_container.end();
+    // Advances CLOCK hand until an unmarked (or expired) entry is met and evicts it,
+    // clearing marks on the way. Returns false if there was nothing to evict.
+    constexpr bool evict                        ()
+    {
+        auto const count_limit  = capacity();
+        auto const stride       = clock_stride();
 
-        return it;
+        for (size_t steps = 0; i_occupancy > 0 && steps < 2 * count_limit; ++steps)
+        {
+            auto const position = i_clock_hand;
+            i_clock_hand = (i_clock_hand + stride) % count_limit;
+
+            if (i_states[position] == bucket_state::occupied && i_references[position] && !is_expired(position))
+            {
+                i_references[position] = 0;
+            }
+            else if (is_occupied_state(i_states[position]))
+            {
+                std::destroy_at(i_values + position);
+                release_bucket(position);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Step of the clock hand: coprime with the capacity, so a round still visits every bucket,
+    // and close to golden ratio of it, so buckets evicted one after another are scattered.
+    // With a unit step free buckets gather behind the hand, while the buckets ahead of it
+    // fill up into one long run that every probe crossing it has to walk.
+    [[nodiscard]]
+    constexpr size_t clock_stride               () const noexcept
+    {
+        auto const count_limit = capacity();
+        if (count_limit < 3) return 1;
+
+        auto stride = static_cast<size_t>(count_limit * 0.6180339887);
+        while (std::gcd(stride, count_limit) != 1) ++stride;
+
+        return stride;
+    }
+
+    constexpr void mark_referenced              (size_t position) const noexcept
+    {
+        if constexpr (s_is_evicting)
+        {
+            if (std::is_constant_evaluated())
+            {
+                i_references[position] = 1;
+            }
+            else
+            {
+                // Skipping the store when the mark is set keeps hot entries' cache lines clean.
+                std::atomic_ref<uint8_t> mark(i_references[position]);
+                if (!mark.load(std::memory_order_relaxed)) mark.store(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Reads a mark possibly being set by concurrent finds.
+    [[nodiscard]]
+    constexpr uint8_t load_reference            (size_t position) const noexcept
+    {
+        if (std::is_constant_evaluated()) return i_references[position];
+
+        return std::atomic_ref<uint8_t>(i_references[position]).load(std::memory_order_relaxed);
+    }
+
+    constexpr void stamp                        (size_t position)
+    {
+        if constexpr (s_is_expiring)
+        {
+            i_timestamps[position] = eviction_policy_type::clock_type::now();
+        }
+    }
+
+    [[nodiscard]]
+    constexpr bool is_expired                   (size_t position) const
+    {
+        if constexpr (s_is_expiring)
+        {
+            return eviction_policy_type::clock_type::now() - i_timestamps[position] > i_eviction_policy.time_to_live;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    [[nodiscard]]
+    constexpr static timestamp_container_type make_timestamps (size_t count)
+    {
+        if constexpr (s_is_expiring)
+        {
+            return timestamp_container_type(count);
+        }
+        else
+        {
+            return timestamp_container_type();
+        }
+    }
+
+    [[nodiscard]]
+    constexpr static reference_container_type make_references (size_t count)
+    {
+        if constexpr (s_is_evicting)
+        {
+            return reference_container_type(count, 0);
+        }
+        else
+        {
+            return reference_container_type();
+        }
     }
 
     [[nodiscard]]
-    constexpr container_iterator find_position          (const_reference value)
+    constexpr static bool is_occupied_state     (bucket_state state) noexcept
     {
-        auto it = const_cast<const self_type *>(this)->find_position(value);
-        return container_iterator(std::next(i_container.begin(), std::distance(i_container.cbegin(), it)));
+        return state == bucket_state::occupied;
     }
 
     [[nodiscard]]
-    constexpr bool is_available_bucket                  (const_container_iterator it) const noexcept
+    constexpr bool is_available_bucket          (size_t position) const noexcept
     {
-        return predicate()(*it, s_empty_value) || predicate()(*it, s_erased_value);
+        return position < capacity() && !is_occupied_state(i_states[position]);
+    }
+
+    template <typename K>
+    [[nodiscard]]
+    constexpr bool is_rejected_value            (K const & value) const noexcept
+    {
+        if constexpr (std::is_void_v<empty_type>)
+        {
+            return false;
+        }
+        else
+        {
+            return predicate()(value, empty_type{});
+        }
     }
 
     [[nodiscard]]
-    constexpr bool is_available_bucket_value            (value_type value) const noexcept
+    constexpr static pointer allocate           (size_t count)
     {
-        return predicate()(value, s_empty_value) || predicate()(value, s_erased_value);
+        allocator_type allocator;
+        return count ? allocator_traits::allocate(allocator, count) : nullptr;
     }
 
-    container_type      i_container;
-    hash_function_type  i_hash_function;
-    predicate_type      i_predicate;
+    constexpr static void deallocate            (pointer values, size_t count) noexcept
+    {
+        allocator_type allocator;
+        if (values) allocator_traits::deallocate(allocator, values, count);
+    }
 
-    size_t              i_occupancy;
+    constexpr void release                      () noexcept
+    {
+        for (size_t position = 0; position < capacity(); ++position)
+        {
+            if (is_occupied_state(i_states[position])) std::destroy_at(i_values + position);
+        }
+
+        deallocate(i_values, capacity());
+        i_values = nullptr;
+        i_states.clear();
+        i_occupancy = 0;
+        i_erased    = 0;
+    }
 
-    constexpr static empty_type     s_empty_value {};
-    constexpr static erased_type    s_erased_value {};
+    pointer                                         i_values;
+    state_container_type                            i_states;
+    [[no_unique_address]] timestamp_container_type  i_timestamps;
+    // Mutable for CLOCK marks set by find, written with relaxed atomic stores only.
+    [[no_unique_address]] mutable reference_container_type i_references;
+    hash_function_type                              i_hash_function;
+    predicate_type                                  i_predicate;
+    [[no_unique_address]] eviction_policy_type      i_eviction_policy;
+
+    size_t                                          i_occupancy;
+    size_t                                          i_erased;
+    size_t                                          i_clock_hand;
 };
 
 }
 
-#endif // __HASHTABLE_HPP__
\ No newline at end of file
+#endif // __HASHTABLE_HPP__
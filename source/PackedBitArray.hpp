@@ -0,0 +1,101 @@
+#ifndef __PACKEDBITARRAY_HPP__
+#define __PACKEDBITARRAY_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace utilities
+{
+
+// Fixed width unsigned fields (0..64 bits each) packed back to back into 64-bit words.
+// A field may straddle two consecutive words.
+class packed_bit_array
+{
+    using word_type = uint64_t;
+
+    constexpr static size_t s_word_bits = 64;
+
+public:
+
+    using value_type = uint64_t;
+
+    constexpr packed_bit_array  (   size_t count
+                                ,   size_t width
+                                )
+    : i_words   ((count * width + s_word_bits - 1) / s_word_bits, 0)
+    , i_count   (count)
+    , i_width   (width)
+    {
+    }
+
+    [[nodiscard]]
+    constexpr value_type get            (size_t index) const noexcept
+    {
+        if (i_width == 0) return 0;
+
+        auto const bit      = index * i_width;
+        auto const word     = bit / s_word_bits;
+        auto const offset   = bit % s_word_bits;
+
+        value_type value = i_words[word] >> offset;
+        if (offset + i_width > s_word_bits)
+        {
+            value |= i_words[word + 1] << (s_word_bits - offset);
+        }
+
+        return value & mask();
+    }
+
+    constexpr void set                  (size_t index, value_type value) noexcept
+    {
+        if (i_width == 0) return;
+
+        auto const bit      = index * i_width;
+        auto const word     = bit / s_word_bits;
+        auto const offset   = bit % s_word_bits;
+
+        value &= mask();
+
+        i_words[word] = (i_words[word] & ~(mask() << offset)) | (value << offset);
+        if (offset + i_width > s_word_bits)
+        {
+            auto const shift = s_word_bits - offset;
+            i_words[word + 1] = (i_words[word + 1] & ~(mask() >> shift)) | (value >> shift);
+        }
+    }
+
+    [[nodiscard]]
+    constexpr size_t size               () const noexcept
+    {
+        return i_count;
+    }
+
+    [[nodiscard]]
+    constexpr size_t width              () const noexcept
+    {
+        return i_width;
+    }
+
+    [[nodiscard]]
+    constexpr size_t memory_usage       () const noexcept
+    {
+        return i_words.size() * sizeof(word_type);
+    }
+
+private:
+
+    [[nodiscard]]
+    constexpr value_type mask           () const noexcept
+    {
+        return i_width >= s_word_bits ? ~value_type{} : (value_type{1} << i_width) - 1;
+    }
+
+    std::vector<word_type>  i_words;
+    size_t                  i_count;
+    size_t                  i_width;
+};
+
+}
+
+#endif // __PACKEDBITARRAY_HPP__
@@ -0,0 +1,448 @@
+#ifndef __QUOTIENTHASHSET_HPP__
+#define __QUOTIENTHASHSET_HPP__
+
+#include "PackedBitArray.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+namespace specialized_datatypes
+{
+
+// Bijection on KeyBits wide integers: xorshift, odd multiplier, xorshift.
+// Every step is invertible modulo 2^KeyBits, so the original key can be
+// restored from its hash.
+template <size_t KeyBits>
+struct invertible_integer_hash
+{
+    static_assert(KeyBits >= 2 && KeyBits <= 64, "Key width must be in range [2, 64] bits");
+
+    using value_type = uint64_t;
+
+    [[nodiscard]]
+    constexpr value_type operator ()    (value_type key) const noexcept
+    {
+        key &= s_mask;
+        key ^= key >> s_shift;
+        key  = (key * s_multiplier) & s_mask;
+        key ^= key >> s_shift;
+        return key;
+    }
+
+    [[nodiscard]]
+    constexpr value_type inverse        (value_type hash) const noexcept
+    {
+        hash &= s_mask;
+        hash ^= hash >> s_shift;
+        hash  = (hash * s_inverse_multiplier) & s_mask;
+        hash ^= hash >> s_shift;
+        return hash;
+    }
+
+private:
+
+    [[nodiscard]]
+    constexpr static value_type multiplicative_inverse (value_type odd) noexcept
+    {
+        // Newton iteration doubles number of correct low bits on each step.
+        value_type inverse = odd;
+        for (int i = 0; i < 5; ++i) inverse *= 2 - odd * inverse;
+        return inverse;
+    }
+
+    constexpr static value_type s_mask                  = KeyBits == 64 ? ~value_type{} : (value_type{1} << KeyBits) - 1;
+    // Shift of at least half of the width makes xorshift its own inverse.
+    constexpr static unsigned   s_shift                 = (KeyBits + 1) / 2;
+    constexpr static value_type s_multiplier            = (0x9E3779B97F4A7C15ull & s_mask) | 1;
+    constexpr static value_type s_inverse_multiplier    = multiplicative_inverse(s_multiplier) & s_mask;
+};
+
+// Set of unsigned integers no wider than KeyBits, storing only the hash remainder.
+//
+// Bucket count is a power of two 2^q; the top q bits of the (invertible) hash select
+// the home bucket and are implied by the slot position, so a slot keeps only the low
+// KeyBits - q remainder bits plus a DisplacementBits wide probe distance.
+// Probing is linear with Robin Hood ordering and erase uses backward shifting,
+// so no tombstones are needed and the original key is restored on iteration.
+template    <   size_t      KeyBits             = 64
+            ,   size_t      DisplacementBits    = 8
+            ,   typename    InvertibleHash      = invertible_integer_hash<KeyBits>
+            >
+class quotient_hash_set
+{
+    static_assert(DisplacementBits >= 2 && DisplacementBits < 64, "Displacement width must be in range [2, 63] bits");
+
+    using container_type    = utilities::packed_bit_array;
+    using slot_type         = typename container_type::value_type;
+    using self_type         = quotient_hash_set<KeyBits, DisplacementBits, InvertibleHash>;
+
+public:
+
+    class table_is_full : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Table is full";
+        }
+    };
+
+    class rebalancing_size_too_small : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Rebalancing size must be bigger then current table size";
+        }
+    };
+
+    using value_type            = uint64_t;
+    using hash_function_type    = InvertibleHash;
+
+    class const_iterator
+    {
+    public:
+
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = typename quotient_hash_set::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = value_type;
+
+        // Keys are not stored as is, so they are reconstructed on every access.
+        constexpr reference operator * () const noexcept
+        {
+            return i_hash_table->key_at(i_position);
+        }
+
+        constexpr const_iterator & operator++ () noexcept
+        {
+            auto const count_limit = i_hash_table->capacity();
+            while   (   i_position < count_limit
+                    &&  i_hash_table->is_available_bucket(++i_position)
+                    );
+
+            return *this;
+        }
+
+        constexpr const_iterator operator++ (int) noexcept
+        {
+            auto current = *this;
+            ++(*this);
+            return current;
+        }
+
+        constexpr const_iterator & operator-- () noexcept
+        {
+            auto const count_limit = i_hash_table->capacity();
+            do
+            {
+                i_position = i_position == 0 ? count_limit : i_position - 1;
+            }
+            while   (   i_position < count_limit
+                    &&  i_hash_table->is_available_bucket(i_position)
+                    );
+
+            return *this;
+        }
+
+        constexpr const_iterator operator-- (int) noexcept
+        {
+            auto current = *this;
+            --(*this);
+            return current;
+        }
+
+        constexpr bool operator == (const_iterator const & it) const noexcept
+        {
+            return i_position == it.i_position;
+        }
+
+        constexpr bool operator != (const_iterator const & it) const noexcept
+        {
+            return !(*this == it);
+        }
+
+    private:
+        constexpr const_iterator    (   quotient_hash_set const *   htable
+                                    ,   size_t                      position
+                                    ) noexcept
+        : i_hash_table  (htable)
+        , i_position    (position)
+        {}
+
+        friend quotient_hash_set;
+
+    private:
+        quotient_hash_set const *   i_hash_table;
+        size_t                      i_position;
+    };
+
+    constexpr explicit quotient_hash_set    (   size_t              reserve_count
+                                            ,   hash_function_type  hasher      = hash_function_type()
+                                            )
+    :   i_quotient_bits     (quotient_bits_for(reserve_count))
+    ,   i_container         (size_t{1} << i_quotient_bits, remainder_bits() + DisplacementBits)
+    ,   i_hash_function     (hasher)
+    ,   i_occupancy         ()
+    {
+    }
+
+    constexpr bool emplace                      (value_type value)
+    {
+        if (value > s_key_mask) return false;
+
+        auto const hash         = hasher()(value);
+        auto const home         = static_cast<size_t>(hash >> remainder_bits());
+        auto const remainder    = hash & remainder_mask();
+        auto const count_limit  = capacity();
+
+        // Locate either the key itself or the slot it is to be placed into.
+        size_t distance = 0;
+        auto position   = home;
+        for (; distance < count_limit; ++distance, position = next(position))
+        {
+            auto const slot = i_container.get(position);
+            if (is_empty_slot(slot) || slot_distance(slot) < distance) break;
+            if (slot_distance(slot) == distance && slot_remainder(slot) == remainder) return false;
+        }
+
+        if (i_occupancy == count_limit || distance > s_max_distance) throw table_is_full();
+
+        // Every entry up to the next empty bucket is shifted by one position;
+        // verify they all still fit before touching anything.
+        auto last = position;
+        for (; !is_empty_slot(i_container.get(last)); last = next(last))
+        {
+            if (slot_distance(i_container.get(last)) == s_max_distance) throw table_is_full();
+        }
+
+        for (; last != position; last = previous(last))
+        {
+            auto const slot = i_container.get(previous(last));
+            i_container.set(last, make_slot(slot_remainder(slot), slot_distance(slot) + 1));
+        }
+
+        i_container.set(position, make_slot(remainder, distance));
+        ++i_occupancy;
+
+        return true;
+    }
+
+    constexpr size_t erase                      (value_type value)
+    {
+        auto position = find_position(value);
+        if (position == capacity()) return 0;
+
+        // Backward shift: pull following entries one bucket closer to their home.
+        auto following = next(position);
+        for (size_t steps = 1; steps < capacity(); ++steps, position = following, following = next(following))
+        {
+            auto const slot = i_container.get(following);
+            if (is_empty_slot(slot) || slot_distance(slot) == 0) break;
+            i_container.set(position, make_slot(slot_remainder(slot), slot_distance(slot) - 1));
+        }
+
+        i_container.set(position, s_empty_slot);
+        --i_occupancy;
+
+        return 1;
+    }
+
+    constexpr void rebalance                    (size_t reserve_count)
+    {
+        if (reserve_count < size()) throw rebalancing_size_too_small();
+
+        self_type rebalanced(reserve_count, i_hash_function);
+        for (auto value : *this)
+        {
+            rebalanced.emplace(value);
+        }
+
+        *this = std::move(rebalanced);
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator find               (value_type value) const
+    {
+        return const_iterator(this, find_position(value));
+    }
+
+    [[nodiscard]]
+    constexpr size_t capacity                   () const noexcept
+    {
+        return i_container.size();
+    }
+
+    [[nodiscard]]
+    constexpr size_t size                       () const noexcept
+    {
+        return i_occupancy;
+    }
+
+    [[nodiscard]]
+    constexpr bool is_empty                     () const noexcept
+    {
+        return i_occupancy == 0;
+    }
+
+    [[nodiscard]]
+    constexpr size_t memory_usage               () const noexcept
+    {
+        return i_container.memory_usage();
+    }
+
+    [[nodiscard]]
+    constexpr size_t slot_width                 () const noexcept
+    {
+        return i_container.width();
+    }
+
+    [[nodiscard]]
+    constexpr hash_function_type const & hasher () const noexcept
+    {
+        return i_hash_function;
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator begin              () const noexcept
+    {
+        const_iterator it(this, 0);
+        if (is_available_bucket(0)) ++it;
+
+        return it;
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator cbegin             () const noexcept
+    {
+        return begin();
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator end                () const noexcept
+    {
+        return const_iterator(this, capacity());
+    }
+
+    [[nodiscard]]
+    constexpr const_iterator cend               () const noexcept
+    {
+        return end();
+    }
+
+private:
+
+    [[nodiscard]]
+    constexpr static size_t quotient_bits_for   (size_t reserve_count) noexcept
+    {
+        // Capacity is kept at least 2^DisplacementBits, so a slot always fits a 64-bit word.
+        size_t bits = DisplacementBits < KeyBits ? DisplacementBits : KeyBits;
+        while (bits < KeyBits && (size_t{1} << bits) < reserve_count) ++bits;
+        return bits;
+    }
+
+    [[nodiscard]]
+    constexpr size_t find_position              (value_type value) const noexcept
+    {
+        auto const count_limit = capacity();
+        if (value > s_key_mask) return count_limit;
+
+        auto const hash         = hasher()(value);
+        auto const remainder    = hash & remainder_mask();
+        auto position           = static_cast<size_t>(hash >> remainder_bits());
+
+        for (size_t distance = 0; distance < count_limit; ++distance, position = next(position))
+        {
+            auto const slot = i_container.get(position);
+            if (is_empty_slot(slot) || slot_distance(slot) < distance) break;
+            if (slot_distance(slot) == distance && slot_remainder(slot) == remainder) return position;
+        }
+
+        return count_limit;
+    }
+
+    [[nodiscard]]
+    constexpr value_type key_at                 (size_t position) const noexcept
+    {
+        auto const slot = i_container.get(position);
+        auto const home = (position - slot_distance(slot)) & (capacity() - 1);
+        auto const hash = (static_cast<value_type>(home) << remainder_bits()) | slot_remainder(slot);
+
+        return hasher().inverse(hash);
+    }
+
+    [[nodiscard]]
+    constexpr bool is_available_bucket          (size_t position) const noexcept
+    {
+        return position < capacity() && is_empty_slot(i_container.get(position));
+    }
+
+    [[nodiscard]]
+    constexpr size_t next                       (size_t position) const noexcept
+    {
+        return (position + 1) & (capacity() - 1);
+    }
+
+    [[nodiscard]]
+    constexpr size_t previous                   (size_t position) const noexcept
+    {
+        return (position - 1) & (capacity() - 1);
+    }
+
+    [[nodiscard]]
+    constexpr size_t remainder_bits             () const noexcept
+    {
+        return KeyBits - i_quotient_bits;
+    }
+
+    [[nodiscard]]
+    constexpr value_type remainder_mask         () const noexcept
+    {
+        return (value_type{1} << remainder_bits()) - 1;
+    }
+
+    // Slot layout: low DisplacementBits hold probe distance + 1 (0 marks an empty slot),
+    // the rest holds hash remainder.
+    [[nodiscard]]
+    constexpr static slot_type make_slot        (value_type remainder, size_t distance) noexcept
+    {
+        return (remainder << DisplacementBits) | (distance + 1);
+    }
+
+    [[nodiscard]]
+    constexpr static bool is_empty_slot         (slot_type slot) noexcept
+    {
+        return (slot & s_distance_mask) == s_empty_slot;
+    }
+
+    [[nodiscard]]
+    constexpr static size_t slot_distance       (slot_type slot) noexcept
+    {
+        return (slot & s_distance_mask) - 1;
+    }
+
+    [[nodiscard]]
+    constexpr static value_type slot_remainder  (slot_type slot) noexcept
+    {
+        return slot >> DisplacementBits;
+    }
+
+    size_t              i_quotient_bits;
+    container_type      i_container;
+    hash_function_type  i_hash_function;
+
+    size_t              i_occupancy;
+
+    constexpr static slot_type  s_empty_slot    {};
+    constexpr static slot_type  s_distance_mask = (slot_type{1} << DisplacementBits) - 1;
+    constexpr static size_t     s_max_distance  = s_distance_mask - 1;
+    constexpr static value_type s_key_mask      = KeyBits == 64 ? ~value_type{} : (value_type{1} << KeyBits) - 1;
+};
+
+}
+
+#endif // __QUOTIENTHASHSET_HPP__
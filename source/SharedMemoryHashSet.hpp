@@ -0,0 +1,401 @@
+#ifndef __SHAREDMEMORYHASHSET_HPP__
+#define __SHAREDMEMORYHASHSET_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace specialized_datatypes
+{
+
+// Open addressing set living in a named POSIX shared memory segment, built once and
+// queried by any number of processes mapping the same segment.
+//
+// The segment holds a header (layout description, element count, hasher and predicate by
+// value) followed by the bucket array at an offset stored in the header, so no pointers
+// are kept inside and every process may map it at its own address. Buckets are
+// std::atomic<T>: find loads with acquire, emplace claims an empty bucket by compare and
+// swap, which makes concurrent inserts from read-write mappings safe. Values are never
+// erased, so probing needs no tombstones.
+//
+// T, HashFunction and Predicate must be trivially copyable, atomics of T lock free,
+// Predicate must provide empty_type. HashFunction maps a value to a bucket of a table of
+// given size, as for open_addressing_hash_set.
+template < typename T, typename HashFunction, typename Predicate>
+class shared_memory_hash_set
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Values are shared between processes as raw bytes");
+    static_assert(std::is_trivially_copyable_v<HashFunction>, "Hasher is stored inside the segment");
+    static_assert(std::is_trivially_copyable_v<Predicate>, "Predicate is stored inside the segment");
+    static_assert(std::atomic<T>::is_always_lock_free, "Locking atomics do not work across processes");
+
+    using bucket_type = std::atomic<T>;
+
+    struct segment_header
+    {
+        uint64_t                i_magic;
+        uint64_t                i_value_size;
+        uint64_t                i_capacity;
+        uint64_t                i_buckets_offset;
+        std::atomic<uint64_t>   i_size;
+        HashFunction            i_hash_function;
+        Predicate               i_predicate;
+    };
+
+    constexpr static size_t s_cache_line_size = 64;
+
+public:
+
+    class table_is_full : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Table is full";
+        }
+    };
+
+    class shared_memory_error : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Shared memory segment could not be created, opened or mapped";
+        }
+    };
+
+    class incompatible_segment : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Shared memory segment does not hold a set of this type";
+        }
+    };
+
+    class read_only_segment : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "Set is mapped read only";
+        }
+    };
+
+    enum class access_mode
+    {
+        read_only,
+        read_write
+    };
+
+    using value_type            = T;
+    using const_reference       = T const &;
+    using hash_function_type    = HashFunction;
+    using predicate_type        = Predicate;
+    using empty_type            = typename predicate_type::empty_type;
+
+    // Creates the segment (failing if the name is taken) with all buckets empty.
+    [[nodiscard]]
+    static shared_memory_hash_set create    (   std::string const &     name
+                                            ,   size_t                  reserve_count
+                                            ,   hash_function_type      hasher      = hash_function_type()
+                                            ,   predicate_type          predicator  = predicate_type()
+                                            )
+    {
+        auto const offset   = buckets_offset();
+        auto const length   = offset + reserve_count * sizeof(bucket_type);
+
+        auto const descriptor = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (descriptor < 0) throw shared_memory_error();
+
+        if (::ftruncate(descriptor, static_cast<off_t>(length)) != 0)
+        {
+            ::close(descriptor);
+            ::shm_unlink(name.c_str());
+            throw shared_memory_error();
+        }
+
+        auto const address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        ::close(descriptor);
+        if (address == MAP_FAILED)
+        {
+            ::shm_unlink(name.c_str());
+            throw shared_memory_error();
+        }
+
+        auto const base     = static_cast<std::byte *>(address);
+        auto const header   = ::new (base) segment_header{s_magic, sizeof(value_type), reserve_count, offset, {0}, hasher, predicator};
+
+        auto const buckets  = reinterpret_cast<bucket_type *>(base + offset);
+        for (size_t position = 0; position < reserve_count; ++position)
+        {
+            ::new (buckets + position) bucket_type(value_type(s_empty_value));
+        }
+
+        return shared_memory_hash_set(name, base, length, header, access_mode::read_write);
+    }
+
+    // Maps an existing segment, read only mappings reject emplace.
+    [[nodiscard]]
+    static shared_memory_hash_set open      (   std::string const &     name
+                                            ,   access_mode             mode        = access_mode::read_only
+                                            )
+    {
+        auto const is_writable = mode == access_mode::read_write;
+
+        auto const descriptor = ::shm_open(name.c_str(), is_writable ? O_RDWR : O_RDONLY, 0);
+        if (descriptor < 0) throw shared_memory_error();
+
+        struct stat status;
+        if (::fstat(descriptor, &status) != 0)
+        {
+            ::close(descriptor);
+            throw shared_memory_error();
+        }
+
+        auto const length = static_cast<size_t>(status.st_size);
+        if (length < sizeof(segment_header))
+        {
+            ::close(descriptor);
+            throw incompatible_segment();
+        }
+
+        auto const address = ::mmap(nullptr, length, is_writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, descriptor, 0);
+        ::close(descriptor);
+        if (address == MAP_FAILED) throw shared_memory_error();
+
+        auto const base     = static_cast<std::byte *>(address);
+        auto const header   = std::launder(reinterpret_cast<segment_header *>(base));
+
+        if (    header->i_magic != s_magic
+            ||  header->i_value_size != sizeof(value_type)
+            ||  header->i_buckets_offset != buckets_offset()
+            ||  header->i_buckets_offset + header->i_capacity * sizeof(bucket_type) > length
+           )
+        {
+            ::munmap(address, length);
+            throw incompatible_segment();
+        }
+
+        return shared_memory_hash_set(name, base, length, header, mode);
+    }
+
+    // Removes the name, mappings stay valid until unmapped.
+    static void remove                      (std::string const & name) noexcept
+    {
+        ::shm_unlink(name.c_str());
+    }
+
+    shared_memory_hash_set                  (shared_memory_hash_set const &) = delete;
+    shared_memory_hash_set & operator =     (shared_memory_hash_set const &) = delete;
+
+    shared_memory_hash_set                  (shared_memory_hash_set && other) noexcept
+    :   i_name              (std::move(other.i_name))
+    ,   i_base              (std::exchange(other.i_base, nullptr))
+    ,   i_length            (std::exchange(other.i_length, 0))
+    ,   i_header            (std::exchange(other.i_header, nullptr))
+    ,   i_buckets           (std::exchange(other.i_buckets, nullptr))
+    ,   i_access_mode       (other.i_access_mode)
+    {
+    }
+
+    shared_memory_hash_set & operator =     (shared_memory_hash_set && other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            i_name          = std::move(other.i_name);
+            i_base          = std::exchange(other.i_base, nullptr);
+            i_length        = std::exchange(other.i_length, 0);
+            i_header        = std::exchange(other.i_header, nullptr);
+            i_buckets       = std::exchange(other.i_buckets, nullptr);
+            i_access_mode   = other.i_access_mode;
+        }
+
+        return *this;
+    }
+
+    // Unmaps only, the segment lives until remove().
+    ~shared_memory_hash_set                 ()
+    {
+        unmap();
+    }
+
+    // Safe against concurrent emplace and find from other processes and threads.
+    bool emplace                            (const_reference value)
+    {
+        if (i_access_mode != access_mode::read_write) throw read_only_segment();
+        if (is_empty_value(value)) return false;
+
+        auto const count_limit          = capacity();
+        auto const expected_position    = hasher()(value);
+
+        for (size_t steps = 0; steps < count_limit; ++steps)
+        {
+            auto & bucket = i_buckets[(expected_position + steps) % count_limit];
+
+            auto current = bucket.load(std::memory_order_acquire);
+            if (is_empty_value(current))
+            {
+                current = value_type(s_empty_value);
+                if (bucket.compare_exchange_strong(current, value, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    i_header->i_size.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+                // Lost the race, current holds the winner.
+            }
+
+            if (predicate()(current, value)) return false;
+        }
+
+        throw table_is_full();
+    }
+
+    [[nodiscard]]
+    bool contains                           (const_reference value) const
+    {
+        if (is_empty_value(value)) return false;
+
+        auto const count_limit          = capacity();
+        auto const expected_position    = hasher()(value);
+
+        for (size_t steps = 0; steps < count_limit; ++steps)
+        {
+            auto const current = i_buckets[(expected_position + steps) % count_limit].load(std::memory_order_acquire);
+            if (is_empty_value(current)) return false;
+            if (predicate()(current, value)) return true;
+        }
+
+        return false;
+    }
+
+    // Hints bucket of the value into cache ahead of contains / emplace.
+    void prefetch                           (const_reference value) const noexcept
+    {
+        if (capacity() == 0) return;
+
+        __builtin_prefetch(i_buckets + hasher()(value));
+    }
+
+    // Calls function with every value, in bucket order.
+    template <typename FunctionT>
+    void for_each                           (FunctionT && function) const
+    {
+        for (size_t position = 0; position < capacity(); ++position)
+        {
+            auto const current = i_buckets[position].load(std::memory_order_acquire);
+            if (!is_empty_value(current)) function(current);
+        }
+    }
+
+    [[nodiscard]]
+    size_t capacity                         () const noexcept
+    {
+        return i_header->i_capacity;
+    }
+
+    [[nodiscard]]
+    size_t size                             () const noexcept
+    {
+        return i_header->i_size.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]]
+    bool is_empty                           () const noexcept
+    {
+        return size() == 0;
+    }
+
+    [[nodiscard]]
+    bool is_read_only                       () const noexcept
+    {
+        return i_access_mode == access_mode::read_only;
+    }
+
+    [[nodiscard]]
+    std::string const & name                () const noexcept
+    {
+        return i_name;
+    }
+
+    // Bytes of the mapped segment.
+    [[nodiscard]]
+    size_t memory_usage                     () const noexcept
+    {
+        return i_length;
+    }
+
+    [[nodiscard]]
+    hash_function_type const & hasher       () const noexcept
+    {
+        return i_header->i_hash_function;
+    }
+
+    [[nodiscard]]
+    predicate_type const & predicate        () const noexcept
+    {
+        return i_header->i_predicate;
+    }
+
+private:
+
+    shared_memory_hash_set                  (   std::string         name
+                                            ,   std::byte *         base
+                                            ,   size_t              length
+                                            ,   segment_header *    header
+                                            ,   access_mode         mode
+                                            )
+    :   i_name              (std::move(name))
+    ,   i_base              (base)
+    ,   i_length            (length)
+    ,   i_header            (header)
+    ,   i_buckets           (std::launder(reinterpret_cast<bucket_type *>(base + header->i_buckets_offset)))
+    ,   i_access_mode       (mode)
+    {
+    }
+
+    // Header rounded up to a cache line, so buckets do not share it with the element count.
+    [[nodiscard]]
+    constexpr static size_t buckets_offset  () noexcept
+    {
+        return (sizeof(segment_header) + s_cache_line_size - 1) / s_cache_line_size * s_cache_line_size;
+    }
+
+    [[nodiscard]]
+    bool is_empty_value                     (const_reference value) const noexcept
+    {
+        return predicate()(value, s_empty_value);
+    }
+
+    void unmap                              () noexcept
+    {
+        if (i_base) ::munmap(i_base, i_length);
+        i_base = nullptr;
+    }
+
+    std::string         i_name;
+    std::byte *         i_base;
+    size_t              i_length;
+    segment_header *    i_header;
+    bucket_type *       i_buckets;
+    access_mode         i_access_mode;
+
+    constexpr static empty_type s_empty_value   {};
+    constexpr static uint64_t   s_magic         = 0x53484D4841534854ull;
+};
+
+}
+
+#endif // __SHAREDMEMORYHASHSET_HPP__
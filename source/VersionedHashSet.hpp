@@ -0,0 +1,297 @@
+#ifndef __VERSIONEDHASHSET_HPP__
+#define __VERSIONEDHASHSET_HPP__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace specialized_datatypes
+{
+
+// Read-mostly wrapper publishing immutable versions of a hash set.
+//
+// Writers build (or copy and patch) a table off to the side and atomically publish it.
+// Readers pin the current version lock-free and query it as a plain const table.
+// Replaced versions are reclaimed with epoch based reclamation: a version retired at
+// epoch E is released once every pinned reader has observed an epoch after E.
+template <typename HashSetT, size_t MaxReaders = 64>
+class versioned_hash_set
+{
+    struct version_node
+    {
+        HashSetT    i_table;
+        uint64_t    i_version;
+    };
+
+    struct alignas(64) reader_slot
+    {
+        std::atomic<bool>       i_in_use    {false};
+        std::atomic<uint64_t>   i_epoch     {s_inactive_epoch};
+        uint32_t                i_pin_depth {0};    // Touched by the owning reader's thread only
+    };
+
+    using self_type = versioned_hash_set<HashSetT, MaxReaders>;
+
+public:
+
+    class too_many_readers : public std::exception
+    {
+    public:
+        const char * what () const noexcept override
+        {
+            return "All reader slots are in use";
+        }
+    };
+
+    using hash_set_type     = HashSetT;
+    using value_type        = typename hash_set_type::value_type;
+    using const_reference   = typename hash_set_type::const_reference;
+
+    // Keeps a version alive while in scope. Iterators obtained from it are valid until then.
+    class snapshot_guard
+    {
+    public:
+
+        snapshot_guard              (snapshot_guard const &) = delete;
+        snapshot_guard & operator = (snapshot_guard const &) = delete;
+
+        snapshot_guard              (snapshot_guard && guard) noexcept
+        : i_slot    (std::exchange(guard.i_slot, nullptr))
+        , i_node    (guard.i_node)
+        {
+        }
+
+        ~snapshot_guard             ()
+        {
+            // Only the outermost guard unpins, nested ones are covered by its older epoch.
+            if (i_slot && --i_slot->i_pin_depth == 0) i_slot->i_epoch.store(s_inactive_epoch, std::memory_order_release);
+        }
+
+        [[nodiscard]]
+        hash_set_type const & operator *    () const noexcept
+        {
+            return i_node->i_table;
+        }
+
+        [[nodiscard]]
+        hash_set_type const * operator ->   () const noexcept
+        {
+            return &i_node->i_table;
+        }
+
+        [[nodiscard]]
+        uint64_t version                    () const noexcept
+        {
+            return i_node->i_version;
+        }
+
+    private:
+        snapshot_guard  (   reader_slot *   slot
+                        ,   version_node *  node
+                        ) noexcept
+        : i_slot    (slot)
+        , i_node    (node)
+        {
+        }
+
+        friend versioned_hash_set;
+
+    private:
+        reader_slot *   i_slot;
+        version_node *  i_node;
+    };
+
+    // Per thread reader handle owning one reader slot. Snapshots pinned through a reader
+    // may nest (e.g. contains while a pin is held), the slot stays pinned until the last
+    // of them is released.
+    class reader
+    {
+    public:
+
+        reader              (reader const &) = delete;
+        reader & operator = (reader const &) = delete;
+
+        reader              (reader && other) noexcept
+        : i_owner   (other.i_owner)
+        , i_slot    (std::exchange(other.i_slot, nullptr))
+        {
+        }
+
+        ~reader             ()
+        {
+            if (i_slot) i_slot->i_in_use.store(false, std::memory_order_release);
+        }
+
+        [[nodiscard]]
+        snapshot_guard pin                  () const noexcept
+        {
+            return i_owner->pin(i_slot);
+        }
+
+        [[nodiscard]]
+        bool contains                       (const_reference value) const
+        {
+            auto snapshot = pin();
+            return snapshot->find(value) != snapshot->end();
+        }
+
+    private:
+        reader  (   versioned_hash_set const *  owner
+                ,   reader_slot *               slot
+                ) noexcept
+        : i_owner   (owner)
+        , i_slot    (slot)
+        {
+        }
+
+        friend versioned_hash_set;
+
+    private:
+        versioned_hash_set const *  i_owner;
+        reader_slot *               i_slot;
+    };
+
+    explicit versioned_hash_set (hash_set_type initial)
+    :   i_current       (new version_node{std::move(initial), 0})
+    ,   i_global_epoch  (s_first_epoch)
+    ,   i_reader_slots  ()
+    ,   i_writer_mutex  ()
+    ,   i_retired       ()
+    {
+    }
+
+    versioned_hash_set              (self_type const &) = delete;
+    versioned_hash_set & operator = (self_type const &) = delete;
+
+    // All readers must be gone by now.
+    ~versioned_hash_set         ()
+    {
+        for (auto & [node, epoch] : i_retired) delete node;
+        delete i_current.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]]
+    reader make_reader          () const
+    {
+        for (auto & slot : i_reader_slots)
+        {
+            bool expected = false;
+            if (    !slot.i_in_use.load(std::memory_order_relaxed)
+                &&  slot.i_in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)
+               )
+            {
+                return reader(this, &slot);
+            }
+        }
+
+        throw too_many_readers();
+    }
+
+    // Replaces current version with the table. Returns new version number.
+    uint64_t publish            (hash_set_type table)
+    {
+        std::lock_guard lock(i_writer_mutex);
+        return publish_locked(std::move(table));
+    }
+
+    // Copies current version, applies patch to the copy and publishes it.
+    template <typename PatchT>
+    uint64_t update             (PatchT && patch)
+    {
+        std::lock_guard lock(i_writer_mutex);
+
+        hash_set_type table(i_current.load(std::memory_order_acquire)->i_table);
+        std::forward<PatchT>(patch)(table);
+
+        return publish_locked(std::move(table));
+    }
+
+    // Releases retired versions no reader can observe any more. Returns number of released versions.
+    size_t collect              ()
+    {
+        std::lock_guard lock(i_writer_mutex);
+        return collect_locked();
+    }
+
+    [[nodiscard]]
+    uint64_t version            () const noexcept
+    {
+        return i_current.load(std::memory_order_acquire)->i_version;
+    }
+
+    [[nodiscard]]
+    size_t retired_count        () const
+    {
+        std::lock_guard lock(i_writer_mutex);
+        return i_retired.size();
+    }
+
+private:
+
+    [[nodiscard]]
+    snapshot_guard pin          (reader_slot * slot) const noexcept
+    {
+        // Sequentially consistent ordering makes either the writer see this epoch while
+        // scanning, or this reader see the node published before the scan. A nested pin
+        // keeps the older epoch, which protects every node retired since.
+        if (slot->i_pin_depth++ == 0) slot->i_epoch.store(i_global_epoch.load());
+        return snapshot_guard(slot, i_current.load());
+    }
+
+    uint64_t publish_locked     (hash_set_type && table)
+    {
+        auto const version  = i_current.load(std::memory_order_relaxed)->i_version + 1;
+        auto const retired  = i_current.exchange(new version_node{std::move(table), version});
+
+        i_retired.emplace_back(retired, i_global_epoch.fetch_add(1));
+        collect_locked();
+
+        return version;
+    }
+
+    size_t collect_locked       ()
+    {
+        auto oldest_pinned = i_global_epoch.load();
+        for (auto const & slot : i_reader_slots)
+        {
+            auto const epoch = slot.i_epoch.load();
+            if (epoch != s_inactive_epoch && epoch < oldest_pinned) oldest_pinned = epoch;
+        }
+
+        size_t released = 0;
+        for (auto it = i_retired.begin(); it != i_retired.end();)
+        {
+            if (it->second < oldest_pinned)
+            {
+                delete it->first;
+                it = i_retired.erase(it);
+                ++released;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        return released;
+    }
+
+    std::atomic<version_node *>                         i_current;
+    std::atomic<uint64_t>                               i_global_epoch;
+    mutable std::array<reader_slot, MaxReaders>         i_reader_slots;
+
+    mutable std::mutex                                  i_writer_mutex;
+    std::vector<std::pair<version_node *, uint64_t>>    i_retired;
+
+    constexpr static uint64_t s_inactive_epoch  = 0;
+    constexpr static uint64_t s_first_epoch     = 1;
+};
+
+}
+
+#endif // __VERSIONEDHASHSET_HPP__
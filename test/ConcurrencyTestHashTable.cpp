@@ -0,0 +1,562 @@
+#include "HashTable.hpp"
+#include "VersionedHashSet.hpp"
+#include "TestHashTable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+using namespace specialized_datatypes;
+
+namespace performance_test
+{
+
+struct test_configuration
+{
+    vector<size_t>  threads_counts      {1, 2, 4, 8};
+    size_t          keys_count          = 1'000'000;
+    size_t          operations_count    = 1'000'000;    // Per thread
+    unsigned        read_percent        = 80;
+    unsigned        insert_percent      = 10;
+    unsigned        erase_percent       = 10;
+    bool            is_zipfian          = true;
+    double          zipf_theta          = 0.99;
+    double          zipf_zeta           = 0;            // Computed once from keys_count and zipf_theta
+    double          rate                = 0;            // Operations per second per thread, 0 - unthrottled
+    bool            is_pinned           = true;
+};
+
+static test_configuration
+parse_configuration     (int argc, char * argv[])
+{
+    test_configuration config;
+
+    auto parse_list = [](string_view text)
+    {
+        vector<size_t> values;
+        stringstream stream{string(text)};
+        for (string item; getline(stream, item, ',');) values.push_back(stoul(item));
+        return values;
+    };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string_view argument(argv[i]);
+        auto const separator = argument.find('=');
+        auto const name      = argument.substr(0, separator);
+        auto const value     = separator == string_view::npos ? string_view() : argument.substr(separator + 1);
+
+        if      (name == "--threads")       config.threads_counts   = parse_list(value);
+        else if (name == "--keys")          config.keys_count       = stoul(string(value));
+        else if (name == "--ops")           config.operations_count = stoul(string(value));
+        else if (name == "--read")          config.read_percent     = stoul(string(value));
+        else if (name == "--insert")        config.insert_percent   = stoul(string(value));
+        else if (name == "--erase")         config.erase_percent    = stoul(string(value));
+        else if (name == "--distribution")  config.is_zipfian       = value == "zipf";
+        else if (name == "--zipf-theta")    config.zipf_theta       = stod(string(value));
+        else if (name == "--rate")          config.rate             = stod(string(value));
+        else if (name == "--no-pin")        config.is_pinned        = false;
+        else
+        {
+            cerr    << "usage: " << argv[0]
+                    << " [--threads=1,2,4] [--keys=N] [--ops=N] [--read=%] [--insert=%] [--erase=%]"
+                    << " [--distribution=zipf|uniform] [--zipf-theta=T] [--rate=ops/s] [--no-pin]" << endl;
+            exit(1);
+        }
+    }
+
+    if (config.read_percent + config.insert_percent + config.erase_percent != 100)
+    {
+        cerr << "read, insert and erase percentages must add up to 100" << endl;
+        exit(1);
+    }
+
+    for (uint64_t i = 1; config.is_zipfian && i <= config.keys_count; ++i)
+    {
+        config.zipf_zeta += 1.0 / pow(static_cast<double>(i), config.zipf_theta);
+    }
+
+    return config;
+}
+
+// Zipfian ranks in [0, count) after Gray et al. "Quickly generating billion-record synthetic databases".
+// Ranks are scrambled by an affine permutation of [0, count) so that hot keys are spread over the
+// table while every key stays reachable.
+class key_generator
+{
+public:
+
+    key_generator   (   test_configuration const &  config
+                    ,   uint64_t                    seed
+                    )
+    : i_rng         (seed)
+    , i_uniform     (0, config.keys_count - 1)
+    , i_real        (0.0, 1.0)
+    , i_count       (config.keys_count)
+    , i_is_zipfian  (config.is_zipfian)
+    , i_theta       (config.zipf_theta)
+    , i_zeta_n      (config.zipf_zeta)
+    , i_alpha       (1.0 / (1.0 - i_theta))
+    , i_eta         (i_is_zipfian ? (1.0 - pow(2.0 / i_count, 1.0 - i_theta)) / (1.0 - (1.0 + pow(0.5, i_theta)) / i_zeta_n) : 0)
+    , i_multiplier  (scramble_multiplier(i_count))
+    {
+    }
+
+    int operator ()     ()
+    {
+        if (!i_is_zipfian) return static_cast<int>(i_uniform(i_rng));
+
+        auto const u    = i_real(i_rng);
+        auto const uz   = u * i_zeta_n;
+
+        uint64_t rank = 0;
+        if      (uz < 1.0)                          rank = 0;
+        else if (uz < 1.0 + pow(0.5, i_theta))      rank = 1;
+        else rank = static_cast<uint64_t>(i_count * pow(i_eta * u - i_eta + 1.0, i_alpha));
+
+        rank = min<uint64_t>(rank, i_count - 1);
+        return static_cast<int>((rank * i_multiplier + s_scramble_offset) % i_count);
+    }
+
+    uint32_t percent    ()
+    {
+        return i_rng() % 100;
+    }
+
+private:
+
+    // Golden ratio fraction of count, moved to the nearest value coprime with it.
+    static uint64_t scramble_multiplier (uint64_t count)
+    {
+        auto multiplier = static_cast<uint64_t>(count * 0.6180339887) | 1;
+        while (gcd(multiplier, count) != 1) ++multiplier;
+
+        return multiplier % count;
+    }
+
+    constexpr static uint64_t s_scramble_offset = 0x9E3779B9ull;
+
+    mt19937_64                          i_rng;
+    uniform_int_distribution<uint64_t>  i_uniform;
+    uniform_real_distribution<double>   i_real;
+    uint64_t                            i_count;
+    bool                                i_is_zipfian;
+    double                              i_theta;
+    double                              i_zeta_n;
+    double                              i_alpha;
+    double                              i_eta;
+    uint64_t                            i_multiplier;
+};
+
+// Log-linear latency histogram: every power of two range is split into 2^s_sub_bucket_bits buckets,
+// giving about 3% relative precision.
+class latency_histogram
+{
+    constexpr static size_t s_sub_bucket_bits   = 5;
+    constexpr static size_t s_sub_bucket_count  = size_t{1} << s_sub_bucket_bits;
+    constexpr static size_t s_bucket_count      = (64 - s_sub_bucket_bits + 1) * s_sub_bucket_count;
+
+public:
+
+    void record         (uint64_t nanoseconds)
+    {
+        ++i_buckets[index_of(nanoseconds)];
+        ++i_count;
+        i_max = max(i_max, nanoseconds);
+    }
+
+    void merge          (latency_histogram const & other)
+    {
+        for (size_t i = 0; i < s_bucket_count; ++i) i_buckets[i] += other.i_buckets[i];
+        i_count += other.i_count;
+        i_max   = max(i_max, other.i_max);
+    }
+
+    // Upper bound of the bucket holding the percentile.
+    [[nodiscard]]
+    uint64_t percentile (double percent) const
+    {
+        auto const target = static_cast<uint64_t>(ceil(i_count * percent / 100.0));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < s_bucket_count; ++i)
+        {
+            seen += i_buckets[i];
+            if (seen >= target && seen > 0) return min(upper_bound_of(i), i_max);
+        }
+        return i_max;
+    }
+
+    [[nodiscard]]
+    uint64_t maximum    () const noexcept
+    {
+        return i_max;
+    }
+
+private:
+
+    [[nodiscard]]
+    static size_t index_of          (uint64_t value) noexcept
+    {
+        if (value < s_sub_bucket_count) return value;
+
+        size_t const magnitude = 63 - __builtin_clzll(value);
+        size_t const shift     = magnitude - s_sub_bucket_bits;
+        return (shift + 1) * s_sub_bucket_count + ((value >> shift) - s_sub_bucket_count);
+    }
+
+    [[nodiscard]]
+    static uint64_t upper_bound_of  (size_t index) noexcept
+    {
+        if (index < s_sub_bucket_count) return index;
+
+        size_t const shift  = index / s_sub_bucket_count - 1;
+        uint64_t const base = (index % s_sub_bucket_count + s_sub_bucket_count) << shift;
+        return base + ((uint64_t{1} << shift) - 1);
+    }
+
+    array<uint64_t, s_bucket_count>     i_buckets   {};
+    uint64_t                            i_count     = 0;
+    uint64_t                            i_max       = 0;
+};
+
+using specialized_hash_table_type = open_addressing_hash_set<   int
+                                                            ,   unit_test::simple_size_hasher
+                                                            ,   unit_test::is_equal
+                                                            >;
+
+// Specialized hash table behind a reader/writer lock.
+class locked_specialized_hash
+{
+public:
+
+    constexpr static string_view s_name = "specialized (shared_mutex)";
+    constexpr static bool s_is_read_only = false;
+
+    explicit locked_specialized_hash (size_t keys_count)
+    : i_table   (2 * keys_count + 1, unit_test::simple_size_hasher(2 * keys_count + 1))
+    {
+    }
+
+    locked_specialized_hash & make_handle ()
+    {
+        return *this;
+    }
+
+    void preload (vector<int> const & keys)
+    {
+        for (auto key : keys) insert(key);
+    }
+
+    bool find   (int key) const
+    {
+        shared_lock lock(i_mutex);
+        return i_table.find(key) != i_table.end();
+    }
+
+    bool insert (int key)
+    {
+        unique_lock lock(i_mutex);
+        try
+        {
+            return i_table.emplace(key);
+        }
+        catch (specialized_hash_table_type::table_is_full & ex)
+        {
+            // Erased buckets used up the free ones, rehash in place drops them.
+            i_table.rebalance(i_table.capacity());
+            return i_table.emplace(key);
+        }
+    }
+
+    bool erase  (int key)
+    {
+        unique_lock lock(i_mutex);
+        return i_table.erase(key);
+    }
+
+private:
+    mutable shared_mutex        i_mutex;
+    specialized_hash_table_type i_table;
+};
+
+// Lock free readers over published snapshots; every write copies the table, so it is
+// measured in read only mixes only.
+class versioned_specialized_hash
+{
+    using versioned_table_type = versioned_hash_set<specialized_hash_table_type, 256>;
+
+public:
+
+    // Per worker handle owning a reader slot.
+    class handle
+    {
+    public:
+
+        explicit handle (versioned_specialized_hash & owner)
+        : i_owner   (owner)
+        , i_reader  (owner.i_table.make_reader())
+        {
+        }
+
+        bool find   (int key) const
+        {
+            return i_reader.contains(key);
+        }
+
+        bool insert (int key)
+        {
+            return i_owner.insert(key);
+        }
+
+        bool erase  (int key)
+        {
+            return i_owner.erase(key);
+        }
+
+    private:
+        versioned_specialized_hash &            i_owner;
+        versioned_table_type::reader            i_reader;
+    };
+
+    constexpr static string_view s_name = "specialized (versioned, lock-free reads)";
+    constexpr static bool s_is_read_only = true;
+
+    explicit versioned_specialized_hash (size_t keys_count)
+    : i_capacity    (2 * keys_count + 1)
+    , i_table       (specialized_hash_table_type(i_capacity, unit_test::simple_size_hasher(i_capacity)))
+    {
+    }
+
+    handle make_handle ()
+    {
+        return handle(*this);
+    }
+
+    // Built off to the side and published once, inserting through update would copy the table per key.
+    void preload (vector<int> const & keys)
+    {
+        specialized_hash_table_type table(i_capacity, unit_test::simple_size_hasher(i_capacity));
+        for (auto key : keys) table.emplace(key);
+
+        i_table.publish(move(table));
+    }
+
+    bool insert (int key)
+    {
+        bool is_inserted = false;
+        i_table.update([key, &is_inserted](specialized_hash_table_type & table) {is_inserted = table.emplace(key);});
+        return is_inserted;
+    }
+
+    bool erase  (int key)
+    {
+        size_t erased = 0;
+        i_table.update([key, &erased](specialized_hash_table_type & table) {erased = table.erase(key);});
+        return erased;
+    }
+
+private:
+    size_t                  i_capacity;
+    versioned_table_type    i_table;
+};
+
+class locked_stl_hash
+{
+public:
+
+    constexpr static string_view s_name = "std::unordered_set (shared_mutex)";
+    constexpr static bool s_is_read_only = false;
+
+    explicit locked_stl_hash (size_t keys_count)
+    : i_table   (2 * keys_count + 1)
+    {
+    }
+
+    locked_stl_hash & make_handle ()
+    {
+        return *this;
+    }
+
+    void preload (vector<int> const & keys)
+    {
+        for (auto key : keys) insert(key);
+    }
+
+    bool find   (int key) const
+    {
+        shared_lock lock(i_mutex);
+        return i_table.find(key) != i_table.end();
+    }
+
+    bool insert (int key)
+    {
+        unique_lock lock(i_mutex);
+        return i_table.insert(key).second;
+    }
+
+    bool erase  (int key)
+    {
+        unique_lock lock(i_mutex);
+        return i_table.erase(key);
+    }
+
+private:
+    mutable shared_mutex    i_mutex;
+    unordered_set<int>      i_table;
+};
+
+static void pin_current_thread (size_t index)
+{
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(index % thread::hardware_concurrency(), &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+}
+
+struct run_result
+{
+    double              throughput;     // Operations per second, all threads
+    latency_histogram   latencies;
+};
+
+// With a rate set, operation i of a thread is scheduled at start + i / rate and its latency is
+// measured from that intended time, so stalls are charged to every operation queued behind them
+// (no coordinated omission). Unthrottled runs measure service time only.
+template <typename TargetT>
+static run_result run_workload  (   test_configuration const &  config
+                                ,   size_t                      threads_count
+                                )
+{
+    TargetT target(config.keys_count);
+
+    key_generator preload(config, 0);
+    vector<int> preload_keys(config.keys_count / 2);
+    for (auto & key : preload_keys) key = preload();
+    target.preload(preload_keys);
+
+    vector<latency_histogram>   histograms(threads_count);
+    atomic<size_t>              ready_count {0};
+    atomic<bool>                is_started  {false};
+
+    auto worker = [&](size_t index)
+    {
+        if (config.is_pinned) pin_current_thread(index);
+
+        key_generator generator(config, index + 1);
+        auto & histogram = histograms[index];
+        decltype(auto) handle = target.make_handle();
+
+        auto const interval = config.rate > 0
+                            ? chrono::nanoseconds(static_cast<int64_t>(1e9 / config.rate))
+                            : chrono::nanoseconds(0);
+
+        ++ready_count;
+        while (!is_started.load(memory_order_acquire));
+
+        auto const start_time = chrono::steady_clock::now();
+        for (size_t i = 0; i < config.operations_count; ++i)
+        {
+            auto const key      = generator();
+            auto const percent  = generator.percent();
+
+            auto intended_time = chrono::steady_clock::now();
+            if (config.rate > 0)
+            {
+                intended_time = start_time + interval * i;
+                while (chrono::steady_clock::now() < intended_time);
+            }
+
+            if      (percent < config.read_percent)                             handle.find(key);
+            else if (percent < config.read_percent + config.insert_percent)     handle.insert(key);
+            else                                                                handle.erase(key);
+
+            histogram.record((chrono::steady_clock::now() - intended_time).count());
+        }
+    };
+
+    vector<thread> threads;
+    for (size_t index = 0; index < threads_count; ++index) threads.emplace_back(worker, index);
+    while (ready_count.load() != threads_count);
+
+    auto const start_time = chrono::steady_clock::now();
+    is_started.store(true, memory_order_release);
+    for (auto & t : threads) t.join();
+    chrono::duration<double> const duration = chrono::steady_clock::now() - start_time;
+
+    run_result result {threads_count * config.operations_count / duration.count(), {}};
+    for (auto const & histogram : histograms) result.latencies.merge(histogram);
+
+    return result;
+}
+
+template <typename TargetT>
+static void report_scaling      (test_configuration const & config)
+{
+    cout << TargetT::s_name << endl;
+
+    if (TargetT::s_is_read_only && config.read_percent != 100)
+    {
+        cout << "  skipped: measured in read only mixes (--read=100) only" << endl;
+        return;
+    }
+
+    double single_thread_throughput = 0;
+    for (auto threads_count : config.threads_counts)
+    {
+        auto const result = run_workload<TargetT>(config, threads_count);
+        if (single_thread_throughput == 0) single_thread_throughput = result.throughput / threads_count;
+
+        cout    << "  threads:"     << setw(3) << threads_count
+                << "  Mops/s:"      << setw(8) << fixed << setprecision(2) << result.throughput / 1e6
+                << "  scaling:"     << setw(6) << setprecision(2) << result.throughput / single_thread_throughput
+                << "  p50 ns:"      << setw(7) << result.latencies.percentile(50)
+                << "  p99 ns:"      << setw(7) << result.latencies.percentile(99)
+                << "  p99.9 ns:"    << setw(8) << result.latencies.percentile(99.9)
+                << "  max ns:"      << setw(9) << result.latencies.maximum()
+                << endl;
+    }
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    auto const config = performance_test::parse_configuration(argc, argv);
+
+    cout    << "keys: "             << config.keys_count
+            << ", ops per thread: " << config.operations_count
+            << ", read/insert/erase: " << config.read_percent << "/" << config.insert_percent << "/" << config.erase_percent
+            << ", distribution: "   << (config.is_zipfian ? "zipf theta " + to_string(config.zipf_theta) : string("uniform"))
+            << ", rate per thread: " << (config.rate > 0 ? to_string(config.rate) + " ops/s" : string("unthrottled"))
+            << endl;
+
+    performance_test::report_scaling<performance_test::locked_specialized_hash>(config);
+    performance_test::report_scaling<performance_test::versioned_specialized_hash>(config);
+    performance_test::report_scaling<performance_test::locked_stl_hash>(config);
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "HashTable.hpp"
+#include "HashSetAlgorithms.hpp"
 #include "SpecialIterators.hpp"
 #include "TestHashTable.hpp"
 
@@ -146,6 +147,18 @@ int main(int argc, char * argv[])
     tie(counter, specialized_duration) = timed_test (find_in_hash, specialized_hash, specialized_hash.end());
     cout << "specialized hash table found:" << counter << ", search time: " << specialized_duration.count() << endl;
 
+    vector<int> probed_keys;
+    probed_keys.reserve(rand_indexes.size());
+    for (auto index : rand_indexes) probed_keys.push_back(rand_numbers_pool[index]);
+    vector<uint64_t> found_bitmap((probed_keys.size() + 63) / 64);
+
+    tie(counter, specialized_duration) = timed_test (   [&specialized_hash, &probed_keys, &found_bitmap]()
+                                                        {
+                                                            return semi_join(specialized_hash, probed_keys, found_bitmap);
+                                                        }
+                                                    );
+    cout << "specialized hash table semi join found:" << counter << ", search time: " << specialized_duration.count() << endl;
+
 
     return 0;
 }
\ No newline at end of file
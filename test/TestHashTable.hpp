@@ -1,14 +1,33 @@
 #ifndef __TESTHASHTABLE_HPP__
 #define __TESTHASHTABLE_HPP__
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace unit_test
 {
 
+template <typename ExceptionT, typename FunctionT, typename... ArgsT>
+bool is_exception_thrown(FunctionT func, ArgsT&&... args)
+{
+    try
+    {
+        func(std::forward<ArgsT>(args)...);
+    }
+    catch (ExceptionT& ex)
+    {
+        return true;
+    }
+
+    return false;
+}
+
 struct simple_size_hasher
 {
 public:
@@ -41,6 +60,140 @@ struct is_equal : public std::equal_to<int>
     using erased_type   = std::integral_constant<int, std::numeric_limits<int>::min()>;
 };
 
+// Bit mixing hashing (splitmix64 finalizer), spreads consecutive keys over the whole table.
+struct mixing_size_hasher
+{
+    constexpr explicit mixing_size_hasher (size_t size)
+    : i_size (size)
+    {
+    }
+
+    [[nodiscard]]
+    constexpr size_t operator ()(int value) const noexcept
+    {
+        uint64_t hash = static_cast<uint32_t>(value) + 0x9E3779B97F4A7C15ull;
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+        return (hash ^ (hash >> 31)) % i_size;
+    }
+
+    [[nodiscard]]
+    constexpr size_t size() const noexcept
+    {
+        return i_size;
+    }
+
+private:
+    size_t i_size;
+};
+
+// is_equal counting its calls, i.e. buckets compared while probing.
+struct is_equal_counted : public is_equal
+{
+    bool operator ()(int lhs, int rhs) const noexcept
+    {
+        ++calls;
+        return lhs == rhs;
+    }
+
+    inline static size_t calls = 0;
+};
+
+// Move only key without spare sentinel values, compared and hashed by pointee.
+struct pointee_hasher
+{
+    constexpr explicit pointee_hasher (size_t size)
+    : i_size (size)
+    {
+    }
+
+    [[nodiscard]]
+    size_t operator ()(std::unique_ptr<int> const & value) const noexcept
+    {
+        return static_cast<size_t>(*value) % i_size;
+    }
+
+private:
+    size_t i_size;
+};
+
+struct is_pointee_equal
+{
+    [[nodiscard]]
+    bool operator ()(std::unique_ptr<int> const & lhs, std::unique_ptr<int> const & rhs) const noexcept
+    {
+        return *lhs == *rhs;
+    }
+};
+
+// Counts copies made, hashed and compared by its value.
+struct copy_counted
+{
+    constexpr copy_counted (int v)
+    : value (v)
+    {
+    }
+
+    copy_counted (copy_counted const & other)
+    : value (other.value)
+    {
+        ++copies;
+    }
+
+    copy_counted (copy_counted && other) noexcept = default;
+
+    copy_counted & operator = (copy_counted const & other) = default;
+    copy_counted & operator = (copy_counted && other) noexcept = default;
+
+    int value;
+
+    inline static size_t copies = 0;
+};
+
+struct copy_counted_hasher
+{
+    constexpr explicit copy_counted_hasher (size_t size)
+    : i_size (size)
+    {
+    }
+
+    [[nodiscard]]
+    size_t operator ()(copy_counted const & value) const noexcept
+    {
+        return static_cast<size_t>(value.value) % i_size;
+    }
+
+private:
+    size_t i_size;
+};
+
+struct is_copy_counted_equal
+{
+    [[nodiscard]]
+    bool operator ()(copy_counted const & lhs, copy_counted const & rhs) const noexcept
+    {
+        return lhs.value == rhs.value;
+    }
+};
+
+// Clock advanced by hand, for time to live tests.
+struct manual_clock
+{
+    using duration      = std::chrono::nanoseconds;
+    using rep           = duration::rep;
+    using period        = duration::period;
+    using time_point    = std::chrono::time_point<manual_clock>;
+
+    constexpr static bool is_steady = true;
+
+    static time_point now () noexcept
+    {
+        return current;
+    }
+
+    inline static time_point current {};
+};
+
 }
 
 #endif // __TESTHASHTABLE_HPP__
\ No newline at end of file
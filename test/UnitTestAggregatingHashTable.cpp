@@ -0,0 +1,268 @@
+#include "AggregatingHashTable.hpp"
+#include "TestHashTable.hpp"
+
+#include <cassert>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace specialized_datatypes;
+
+namespace unit_test
+{
+
+constexpr size_t hash_size = 53;
+
+constexpr is_equal::empty_type empty_value_0{};
+
+using counting_table_type   = aggregating_hash_table<   int
+                                                    ,   count_aggregate
+                                                    ,   simple_size_hasher
+                                                    ,   is_equal
+                                                    >;
+
+using statistics_table_type = aggregating_hash_table<   int
+                                                    ,   statistics_aggregate<long>
+                                                    ,   simple_size_hasher
+                                                    ,   is_equal
+                                                    >;
+
+void test_counting_table_upsert                 ()
+{
+    counting_table_type table(hash_size, simple_size_hasher(hash_size));
+    assert(table.is_empty());
+    assert(table.capacity() == hash_size);
+
+    assert(table.upsert_add(1, 1));
+    assert(!table.upsert_add(1, 2));
+    assert(table.upsert_add(1 + hash_size, 5)); // Conflicting key
+    assert(!table.upsert_add(empty_value_0, 1));
+    assert(table.size() == 2);
+
+    assert(table.find(1)->second == 3);
+    assert(table.find(1 + hash_size)->second == 5);
+    assert(table.find(2) == table.end());
+    assert(table.find(empty_value_0) == table.end());
+
+    std::vector<int> const keys {7, 3, 7, 7, 3, 11, 7, 3, 7, 100, 7, 3, 42};
+    table.upsert_add(keys);
+    assert(table.find(7)->second == 6);
+    assert(table.find(3)->second == 4);
+    assert(table.find(42)->second == 1);
+    assert(table.size() == 7);
+
+    std::vector<size_t> const inputs {10, 20};
+    table.upsert_add(std::vector<int>{42, 5}, inputs);
+    assert(table.find(42)->second == 11);
+    assert(table.find(5)->second == 20);
+
+    assert  (   is_exception_thrown<counting_table_type::batch_size_mismatch>(
+                    [&table, &inputs]() {table.upsert_add(std::vector<int>{1}, inputs);}
+                )
+            );
+
+    size_t total = 0;
+    for (auto const & [key, count] : table) total += count;
+    assert(total == 3 + 5 + keys.size() + 30);
+
+    table.clear();
+    assert(table.is_empty());
+    assert(table.begin() == table.end());
+    assert(table.find(7) == table.end());
+}
+
+void test_counting_table_full                   ()
+{
+    counting_table_type table(3, simple_size_hasher(3));
+    table.upsert_add(std::vector<int>{0, 1, 2});
+
+    assert(!table.upsert_add(1, 1));
+    assert  (   is_exception_thrown<counting_table_type::table_is_full>(
+                    [&table]() {table.upsert_add(3, 1);}
+                )
+            );
+}
+
+void test_statistics_table                      ()
+{
+    statistics_table_type table(hash_size, simple_size_hasher(hash_size));
+
+    table.upsert_add(std::vector<int>{1, 2, 1, 1}, std::vector<long>{10, -4, -3, 8});
+
+    auto const & first = table.find(1)->second;
+    assert(first.count == 3);
+    assert(first.sum == 15);
+    assert(first.min == -3);
+    assert(first.max == 10);
+
+    auto const & second = table.find(2)->second;
+    assert(second.count == 1);
+    assert(second.min == -4 && second.max == -4);
+}
+
+void test_table_top_k                           ()
+{
+    counting_table_type table(hash_size, simple_size_hasher(hash_size));
+    for (int key = 1; key <= 20; ++key)
+    {
+        table.upsert_add(key, static_cast<size_t>(key * key));
+    }
+
+    auto const heaviest = table.top_k(3);
+    assert(heaviest.size() == 3);
+    assert(heaviest[0] == std::make_pair(20, size_t{400}));
+    assert(heaviest[1] == std::make_pair(19, size_t{361}));
+    assert(heaviest[2] == std::make_pair(18, size_t{324}));
+
+    assert(table.top_k(100).size() == 20);
+
+    auto const lightest = table.top_k(2, [](size_t lhs, size_t rhs) {return lhs < rhs;});
+    assert(lightest[0].first == 1);
+    assert(lightest[1].first == 2);
+}
+
+void test_move_only_keys_table                  ()
+{
+    using pointer_table_type = aggregating_hash_table<std::unique_ptr<int>, count_aggregate, pointee_hasher, is_pointee_equal>;
+
+    pointer_table_type table(hash_size, pointee_hasher(hash_size));
+    assert(table.upsert_add(std::make_unique<int>(5), 1));
+    assert(!table.upsert_add(std::make_unique<int>(5), 2));
+    assert(table.upsert_add(std::make_unique<int>(5 + hash_size), 4));
+    assert(table.size() == 2);
+
+    assert(table.find(std::make_unique<int>(5))->second == 3);
+    assert(table.find(std::make_unique<int>(6)) == table.end());
+
+    pointer_table_type total(hash_size, pointee_hasher(hash_size));
+    total.upsert_add(std::make_unique<int>(5), 10);
+    total.drain(table);
+    assert(table.is_empty());
+    assert(total.size() == 2);
+    assert(total.find(std::make_unique<int>(5))->second == 13);
+    assert(total.find(std::make_unique<int>(5 + hash_size))->second == 4);
+}
+
+void test_partial_aggregation                   ()
+{
+    constexpr size_t threads_count = 4;
+
+    counting_table_type prototype(hash_size, simple_size_hasher(hash_size));
+    partial_aggregation<counting_table_type> partials(threads_count, prototype);
+    assert(partials.partials_count() == threads_count);
+
+    std::vector<std::thread> threads;
+    for (size_t index = 0; index < threads_count; ++index)
+    {
+        threads.emplace_back    (   [&partials, index]()
+                                    {
+                                        for (int i = 0; i < 1000; ++i)
+                                        {
+                                            partials.partial(index).upsert_add(i % 10, 1);
+                                        }
+                                    }
+                                );
+    }
+    for (auto & thread : threads) thread.join();
+
+    counting_table_type total(hash_size, simple_size_hasher(hash_size));
+    partials.flush(total);
+
+    assert(total.size() == 10);
+    for (int key = 0; key < 10; ++key)
+    {
+        assert(total.find(key)->second == threads_count * 100);
+    }
+
+    for (size_t index = 0; index < threads_count; ++index)
+    {
+        assert(partials.partial(index).is_empty());
+    }
+
+    partials.partial(0).upsert_add(3, 1);
+    partials.flush(total);
+    assert(total.find(3)->second == threads_count * 100 + 1);
+}
+
+void test_partial_aggregation_retry             ()
+{
+    counting_table_type prototype(hash_size, simple_size_hasher(hash_size));
+    partial_aggregation<counting_table_type> partials(2, prototype);
+
+    partials.partial(0).upsert_add(std::vector<int>{0, 1, 1});
+    partials.partial(1).upsert_add(std::vector<int>{1, 2, 2, 2});
+
+    // Room for keys 0 and 1 only, key 2 of the second partial does not fit.
+    counting_table_type small(2, simple_size_hasher(2));
+    assert  (   is_exception_thrown<counting_table_type::table_is_full>(
+                    [&partials, &small]() {partials.flush(small);}
+                )
+            );
+    assert(partials.partial(0).is_empty());
+
+    // Merged key 1 left the second partial, only the failed key is kept.
+    assert(partials.partial(1).size() == 1);
+    assert(partials.partial(1).find(1) == partials.partial(1).end());
+    assert(partials.partial(1).find(2)->second == 3);
+
+    counting_table_type total(hash_size, simple_size_hasher(hash_size));
+    total.drain(small);
+    partials.flush(total);
+
+    // Nothing merged before the failure is counted twice or lost.
+    assert(total.size() == 3);
+    assert(total.find(0)->second == 1);
+    assert(total.find(1)->second == 3);
+    assert(total.find(2)->second == 3);
+    assert(partials.partial(1).is_empty());
+    assert(small.is_empty());
+}
+
+void test_partial_aggregation_retry_fresh_target ()
+{
+    counting_table_type prototype(hash_size, simple_size_hasher(hash_size));
+    partial_aggregation<counting_table_type> partials(1, prototype);
+    partials.partial(0).upsert_add(std::vector<int>{1, 2, 2, 3, 3, 3});
+
+    counting_table_type small(2, simple_size_hasher(2));
+    assert  (   is_exception_thrown<counting_table_type::table_is_full>(
+                    [&partials, &small]() {partials.flush(small);}
+                )
+            );
+
+    // A fresh target gets no phantom entries of the keys merged into the failed one.
+    counting_table_type total(hash_size, simple_size_hasher(hash_size));
+    partials.flush(total);
+    assert(total.size() == 1);
+    assert(total.find(3)->second == 3);
+
+    total.drain(small);
+    assert(total.size() == 3);
+
+    size_t sum = 0;
+    for (auto const & [key, count] : total)
+    {
+        assert(count == static_cast<size_t>(key));
+        sum += count;
+    }
+    assert(sum == 6);
+
+    auto const heaviest = total.top_k(3);
+    assert(heaviest.size() == 3);
+    assert(heaviest[2] == std::make_pair(1, size_t{1}));
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    unit_test::test_counting_table_upsert();
+    unit_test::test_counting_table_full();
+    unit_test::test_statistics_table();
+    unit_test::test_table_top_k();
+    unit_test::test_move_only_keys_table();
+    unit_test::test_partial_aggregation();
+    unit_test::test_partial_aggregation_retry();
+    unit_test::test_partial_aggregation_retry_fresh_target();
+}
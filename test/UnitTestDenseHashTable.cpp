@@ -0,0 +1,265 @@
+#include "DenseHashTable.hpp"
+#include "TestHashTable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace specialized_datatypes;
+
+namespace unit_test
+{
+
+constexpr size_t hash_size = 53;
+
+using dense_set_type = dense_hash_set<int, simple_size_hasher, is_equal>;
+
+void test_dense_set_emplace_find                ()
+{
+    dense_set_type set(hash_size, simple_size_hasher(hash_size));
+    assert(set.is_empty());
+    assert(set.capacity() == hash_size);
+    assert(set.begin() == set.end());
+
+    assert(set.emplace(42));
+    assert(set.emplace(13));
+    assert(set.emplace(42 + hash_size)); // Conflicting key
+    assert(!set.emplace(13));
+    assert(set.emplace(7));
+    assert(set.size() == 4);
+
+    assert(*set.find(42) == 42);
+    assert(*set.find(42 + hash_size) == 42 + hash_size);
+    assert(set.find(1) == set.end());
+
+    // Insertion order, not bucket order.
+    std::vector<int> const expected {42, 13, 42 + hash_size, 7};
+    assert(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+    assert(std::equal(set.values().begin(), set.values().end(), expected.begin(), expected.end()));
+}
+
+void test_dense_set_erase                       ()
+{
+    dense_set_type set(hash_size, simple_size_hasher(hash_size));
+    for (int value : {1, 2, 3, 1 + static_cast<int>(hash_size), 4}) set.emplace(value);
+
+    assert(set.erase(2) == 1);
+    assert(set.erase(2) == 0);
+    assert(set.size() == 4);
+
+    // Last element fills the hole.
+    std::vector<int> const expected {1, 4, 3, 1 + hash_size};
+    assert(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+
+    for (int value : expected)
+    {
+        assert(*set.find(value) == value);
+    }
+
+    // Erased bucket on probe path of the conflicting key.
+    assert(set.erase(1) == 1);
+    assert(*set.find(1 + hash_size) == 1 + hash_size);
+    assert(set.erase(1 + hash_size) == 1);
+    assert(set.erase(4) == 1);
+    assert(set.erase(3) == 1);
+    assert(set.is_empty());
+    assert(set.find(3) == set.end());
+}
+
+void test_dense_set_full                        ()
+{
+    dense_set_type set(3, simple_size_hasher(3));
+    assert(set.emplace(0));
+    assert(set.emplace(1));
+    assert(set.emplace(2));
+    assert(!set.emplace(1));
+    assert  (   is_exception_thrown<dense_set_type::table_is_full>(
+                    [&set]() {set.emplace(3);}
+                )
+            );
+
+    // Erased buckets are reclaimed once no empty bucket is left.
+    assert(set.erase(0) == 1);
+    assert(set.emplace(3));
+    assert(set.size() == 3);
+    for (int value : {1, 2, 3})
+    {
+        assert(*set.find(value) == value);
+    }
+}
+
+void test_dense_set_rebalance                   ()
+{
+    dense_set_type set(hash_size, simple_size_hasher(hash_size));
+    for (int value = 0; value < 40; ++value) set.emplace(value * 3);
+    set.erase(9);
+
+    std::vector<int> const order(set.begin(), set.end());
+
+    set.rebalance(2 * hash_size + 1, simple_size_hasher(2 * hash_size + 1));
+    assert(set.capacity() == 2 * hash_size + 1);
+    assert(set.size() == 39);
+
+    // Elements stay in place.
+    assert(std::equal(set.begin(), set.end(), order.begin(), order.end()));
+    for (int value : order)
+    {
+        assert(*set.find(value) == value);
+    }
+    assert(set.find(9) == set.end());
+
+    assert  (   is_exception_thrown<dense_set_type::rebalancing_size_too_small>(
+                    [&set]() {set.rebalance(10, simple_size_hasher(10));}
+                )
+            );
+    assert(set.capacity() == 2 * hash_size + 1);
+}
+
+void test_dense_set_index_range                 ()
+{
+    using small_set_type = dense_hash_set<int, simple_size_hasher, is_equal, uint8_t>;
+
+    small_set_type set(254, simple_size_hasher(254));
+    for (int value = 0; value < 254; ++value)
+    {
+        assert(set.emplace(value));
+    }
+    assert(*set.find(253) == 253);
+
+    assert  (   is_exception_thrown<small_set_type::capacity_too_large>(
+                    []() {small_set_type too_large(255, simple_size_hasher(255));}
+                )
+            );
+    assert  (   is_exception_thrown<small_set_type::capacity_too_large>(
+                    [&set]() {set.rebalance(300, simple_size_hasher(300));}
+                )
+            );
+    assert(set.capacity() == 254);
+}
+
+void test_dense_set_memory_usage                ()
+{
+    using large_type = std::array<int, 16>;
+
+    struct large_hasher
+    {
+        size_t operator ()(large_type const & value) const noexcept
+        {
+            return static_cast<size_t>(value[0]) % size;
+        }
+
+        size_t size;
+    };
+
+    using large_set_type = dense_hash_set<large_type, large_hasher, std::equal_to<large_type>, uint16_t>;
+
+    constexpr size_t capacity = 1000;
+    large_set_type set(capacity, large_hasher{capacity});
+    for (int value = 0; value < 100; ++value) set.emplace(large_type{value});
+
+    // Empty buckets cost an index only.
+    assert(set.memory_usage() >= capacity * sizeof(uint16_t) + 100 * sizeof(large_type));
+    assert(set.memory_usage() < capacity * sizeof(large_type) / 4);
+    assert((*set.find(large_type{42}))[0] == 42);
+}
+
+void test_dense_set_move_only                   ()
+{
+    using pointer_set_type = dense_hash_set<std::unique_ptr<int>, pointee_hasher, is_pointee_equal>;
+
+    pointer_set_type set(hash_size, pointee_hasher(hash_size));
+    assert(set.emplace(std::make_unique<int>(5)));
+    assert(set.emplace(std::make_unique<int>(5 + hash_size)));
+    assert(set.emplace(std::make_unique<int>(6)));
+
+    auto duplicate = std::make_unique<int>(5);
+    assert(!set.emplace(std::move(duplicate)));
+    assert(duplicate); // Left intact
+
+    assert(set.erase(std::make_unique<int>(5)) == 1);
+    assert(**set.find(std::make_unique<int>(5 + hash_size)) == 5 + hash_size);
+    assert(**set.begin() == 6);
+
+    set.rebalance(2 * hash_size);
+    assert(**set.find(std::make_unique<int>(6)) == 6);
+}
+
+
+void test_dense_set_throwing_move               ()
+{
+    struct throwing_value
+    {
+        throwing_value (int value, bool const & is_throwing)
+        : i_value       (value)
+        , i_is_throwing (&is_throwing)
+        {
+        }
+
+        throwing_value (throwing_value && other)
+        : i_value       (other.i_value)
+        , i_is_throwing (other.i_is_throwing)
+        {
+            if (*i_is_throwing) throw std::runtime_error("move failed");
+        }
+
+        throwing_value & operator = (throwing_value && other) = default;
+
+        int             i_value;
+        bool const *    i_is_throwing;
+    };
+
+    struct throwing_hasher
+    {
+        size_t operator ()(throwing_value const & value) const noexcept
+        {
+            return static_cast<size_t>(value.i_value) % size;
+        }
+
+        size_t size;
+    };
+
+    struct is_throwing_equal
+    {
+        bool operator ()(throwing_value const & lhs, throwing_value const & rhs) const noexcept
+        {
+            return lhs.i_value == rhs.i_value;
+        }
+    };
+
+    using throwing_set_type = dense_hash_set<throwing_value, throwing_hasher, is_throwing_equal>;
+
+    bool is_throwing = false;
+    throwing_set_type set(hash_size, throwing_hasher{hash_size});
+    assert(set.emplace(throwing_value(1, is_throwing)));
+
+    is_throwing = true;
+    assert  (   is_exception_thrown<std::runtime_error>(
+                    [&set, &is_throwing]() {set.emplace(throwing_value(1 + hash_size, is_throwing));}
+                )
+            );
+    is_throwing = false;
+
+    // Failed insertion claims no bucket.
+    assert(set.size() == 1);
+    assert(set.find(throwing_value(1 + hash_size, is_throwing)) == set.end());
+    assert(set.emplace(throwing_value(1 + hash_size, is_throwing)));
+    assert(set.find(throwing_value(1 + hash_size, is_throwing))->i_value == 1 + hash_size);
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    unit_test::test_dense_set_emplace_find();
+    unit_test::test_dense_set_erase();
+    unit_test::test_dense_set_full();
+    unit_test::test_dense_set_rebalance();
+    unit_test::test_dense_set_index_range();
+    unit_test::test_dense_set_memory_usage();
+    unit_test::test_dense_set_move_only();
+    unit_test::test_dense_set_throwing_move();
+}
@@ -0,0 +1,217 @@
+#include "DiskPartitionedHashSet.hpp"
+#include "TestHashTable.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace specialized_datatypes;
+
+namespace unit_test
+{
+
+constexpr is_equal::empty_type empty_value_0{};
+
+constexpr size_t partition_bits     = 3;
+constexpr size_t partition_capacity = 64;
+// Room for a couple of small partitions only.
+constexpr size_t memory_budget      = 4 * partition_capacity * (sizeof(int) + 1);
+
+using disk_set_type = disk_partitioned_hash_set<int, std::hash<int>, is_equal>;
+
+// Fresh directory, removed on scope exit.
+struct scoped_directory
+{
+    explicit scoped_directory (std::string const & name)
+    : i_path (std::filesystem::temp_directory_path() / name)
+    {
+        std::filesystem::remove_all(i_path);
+    }
+
+    ~scoped_directory ()
+    {
+        std::filesystem::remove_all(i_path);
+    }
+
+    std::filesystem::path i_path;
+};
+
+disk_set_type make_set (std::filesystem::path const & path, size_t buffer_limit = 16)
+{
+    return disk_set_type(path, partition_bits, memory_budget, std::hash<int>(), is_equal(), partition_capacity, buffer_limit);
+}
+
+void test_disk_set_emplace_and_spill            ()
+{
+    scoped_directory const directory("unit_test_disk_set_emplace");
+    auto set = make_set(directory.i_path);
+
+    assert(set.partitions_count() == 1 << partition_bits);
+    assert(set.size() == 0);
+
+    for (int key = 0; key < 2000; ++key)
+    {
+        assert(set.emplace(key));
+    }
+    assert(!set.emplace(7));
+    assert(!set.emplace(empty_value_0));
+    assert(set.size() == 2000);
+
+    // Tables grew past the budget, so all but the most recent partition were spilled.
+    assert(set.resident_count() == 1);
+
+    for (int key = 0; key < 2000; ++key)
+    {
+        assert(set.contains(key));
+    }
+    assert(!set.contains(2000));
+    assert(!set.contains(-1));
+    assert(!set.contains(empty_value_0));
+}
+
+void test_disk_set_memory_budget                ()
+{
+    scoped_directory const directory("unit_test_disk_set_budget");
+    auto set = make_set(directory.i_path);
+
+    // Partitions grow while resident, others are dropped as soon as the growth crosses the budget.
+    // A single partition larger than the budget cannot be dropped and stays resident alone.
+    for (int key = 0; key < 4000; ++key)
+    {
+        set.emplace(key * 7919);
+        assert(set.resident_memory() <= memory_budget || set.resident_count() == 1);
+    }
+
+    for (int key = 0; key < 4000; key += 3)
+    {
+        set.insert_buffered(-key * 7919 - 1);
+        assert(set.resident_memory() <= memory_budget || set.resident_count() == 1);
+    }
+
+    set.compact();
+    assert(set.size() == 4000 + 1334);
+    assert(set.resident_memory() <= memory_budget || set.resident_count() == 1);
+}
+
+void test_disk_set_buffered_insert              ()
+{
+    scoped_directory const directory("unit_test_disk_set_buffered");
+    auto set = make_set(directory.i_path);
+
+    for (int key = 0; key < 1000; ++key)
+    {
+        set.insert_buffered(key);
+        set.insert_buffered(key); // Duplicates are dropped on merge
+    }
+    assert(set.resident_count() == 0);
+    assert(set.size() == 0);
+    assert(set.pending_count() == 2000);
+
+    set.flush();
+    assert(set.pending_count() == 2000);
+    assert(!std::filesystem::is_empty(directory.i_path));
+
+    set.compact();
+    assert(set.pending_count() == 0);
+    assert(set.size() == 1000);
+
+    for (int key = 0; key < 1000; ++key)
+    {
+        assert(set.contains(key));
+    }
+
+    // Goes directly into the resident partition.
+    set.insert_buffered(1000);
+    assert(set.contains(1000));
+}
+
+void test_disk_set_contains_batch               ()
+{
+    scoped_directory const directory("unit_test_disk_set_batch");
+    auto set = make_set(directory.i_path);
+
+    for (int key = 0; key < 1000; key += 2)
+    {
+        set.insert_buffered(key);
+    }
+
+    std::vector<int> keys;
+    for (int key = 999; key >= 0; --key) keys.push_back(key);
+
+    std::vector<uint64_t> bitmap((keys.size() + 63) / 64, ~uint64_t{0});
+    assert(set.contains_batch(keys, bitmap) == 500);
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        bool const is_found = (bitmap[i / 64] >> (i % 64)) & 1;
+        assert(is_found == (keys[i] % 2 == 0));
+    }
+    assert(set.size() == 500);
+
+    std::vector<uint64_t> small_bitmap(1);
+    assert  (   is_exception_thrown<bitmap_too_small>(
+                    [&set, &keys, &small_bitmap]() {set.contains_batch(keys, small_bitmap);}
+                )
+            );
+}
+
+void test_disk_set_reopen                       ()
+{
+    scoped_directory const directory("unit_test_disk_set_reopen");
+
+    {
+        auto set = make_set(directory.i_path);
+        for (int key = 0; key < 500; ++key) set.emplace(key);
+        for (int key = 500; key < 700; ++key) set.insert_buffered(key);
+    }
+
+    auto set = make_set(directory.i_path);
+    // Values buffered for the partition left resident were merged right away.
+    assert(set.size() >= 500);
+    assert(set.size() + set.pending_count() == 700);
+
+    for (int key = 0; key < 700; ++key)
+    {
+        assert(set.contains(key));
+    }
+    assert(!set.contains(700));
+
+    set.compact();
+    assert(set.size() == 700);
+
+    set.flush();
+
+    // Partition files of another partitioning or at another position are rejected.
+    assert  (   is_exception_thrown<disk_set_type::corrupted_partition>(
+                    [&directory]() {disk_set_type other(directory.i_path, partition_bits - 1, memory_budget);}
+                )
+            );
+    std::filesystem::copy_file  (   directory.i_path / "partition_1.table"
+                                ,   directory.i_path / "partition_0.table"
+                                ,   std::filesystem::copy_options::overwrite_existing
+                                );
+    assert  (   is_exception_thrown<disk_set_type::corrupted_partition>(
+                    [&directory]() {auto moved = make_set(directory.i_path);}
+                )
+            );
+
+    std::filesystem::resize_file(directory.i_path / "partition_0.table", 8);
+    assert  (   is_exception_thrown<disk_set_type::corrupted_partition>(
+                    [&directory]() {auto broken = make_set(directory.i_path);}
+                )
+            );
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    unit_test::test_disk_set_emplace_and_spill();
+    unit_test::test_disk_set_memory_budget();
+    unit_test::test_disk_set_buffered_insert();
+    unit_test::test_disk_set_contains_batch();
+    unit_test::test_disk_set_reopen();
+}
@@ -0,0 +1,131 @@
+#include "HashTable.hpp"
+#include "HashSetAlgorithms.hpp"
+#include "TestHashTable.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+using namespace specialized_datatypes;
+
+namespace unit_test
+{
+
+constexpr size_t hash_size = 101;
+
+using hash_table_type = open_addressing_hash_set<   int
+                                                ,   simple_size_hasher
+                                                ,   is_equal
+                                                >;
+
+hash_table_type make_table                      (std::vector<int> const & values)
+{
+    hash_table_type table(hash_size, simple_size_hasher(hash_size));
+    for (auto value : values) table.emplace(value);
+    return table;
+}
+
+std::vector<int> sorted                         (std::vector<int> values)
+{
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+// Multiples of 2 and multiples of 3 below 60.
+std::vector<int> const first_values     = [](){std::vector<int> v; for (int i = 0; i < 60; i += 2) v.push_back(i); return v;}();
+std::vector<int> const second_values    = [](){std::vector<int> v; for (int i = 0; i < 60; i += 3) v.push_back(i); return v;}();
+
+void test_set_intersect                         ()
+{
+    auto first  = make_table(first_values);
+    auto second = make_table(second_values);
+
+    std::vector<int> result;
+    intersect(first, second, std::back_inserter(result));
+    assert(sorted(result) == std::vector<int>({0, 6, 12, 18, 24, 30, 36, 42, 48, 54}));
+
+    std::vector<int> swapped;
+    intersect(second, first, std::back_inserter(swapped));
+    assert(sorted(swapped) == sorted(result));
+
+    std::vector<int> buffer(first.size());
+    auto last = intersect(first, make_table({}), buffer.begin());
+    assert(last == buffer.begin());
+}
+
+void test_set_difference                        ()
+{
+    auto first  = make_table(first_values);
+    auto second = make_table(second_values);
+
+    std::vector<int> result;
+    difference(first, second, std::back_inserter(result));
+    assert(result.size() == first.size() - 10);
+    for (auto value : result)
+    {
+        assert(value % 2 == 0 && value % 3 != 0);
+    }
+
+    result.clear();
+    difference(second, first, std::back_inserter(result));
+    assert(sorted(result) == std::vector<int>({3, 9, 15, 21, 27, 33, 39, 45, 51, 57}));
+}
+
+void test_set_unite                             ()
+{
+    auto first  = make_table(first_values);
+    auto second = make_table(second_values);
+
+    std::vector<int> result;
+    unite(first, second, std::back_inserter(result));
+
+    std::vector<int> expected;
+    for (int i = 0; i < 60; ++i)
+    {
+        if (i % 2 == 0 || i % 3 == 0) expected.push_back(i);
+    }
+    assert(sorted(result) == expected);
+}
+
+void test_set_semi_join                         ()
+{
+    auto table = make_table(first_values);
+
+    // Crosses bitmap word boundary and probe batch boundary.
+    std::vector<int> keys;
+    for (int i = 0; i < 70; ++i) keys.push_back(i);
+
+    std::vector<uint64_t> bitmap(2, ~uint64_t{0});
+    assert(semi_join(table, keys, bitmap) == 30);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        bool const is_set = bitmap[i / 64] & (uint64_t{1} << (i % 64));
+        assert(is_set == (keys[i] < 60 && keys[i] % 2 == 0));
+    }
+
+    assert(anti_join(table, keys, bitmap) == 40);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        bool const is_set = bitmap[i / 64] & (uint64_t{1} << (i % 64));
+        assert(is_set == !(keys[i] < 60 && keys[i] % 2 == 0));
+    }
+
+    std::vector<uint64_t> small_bitmap(1);
+    assert  (   is_exception_thrown<bitmap_too_small>(
+                    [&]() {semi_join(table, keys, small_bitmap);}
+                )
+            );
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    unit_test::test_set_intersect();
+    unit_test::test_set_difference();
+    unit_test::test_set_unite();
+    unit_test::test_set_semi_join();
+}
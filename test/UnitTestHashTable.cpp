@@ -3,6 +3,8 @@
 
 #include <cassert>
 #include <iterator>
+#include <thread>
+#include <vector>
 #include <utility>
 
 #include <iostream>
@@ -12,23 +14,6 @@ using namespace specialized_datatypes;
 namespace unit_test
 {
 
-template <typename ExceptionT, typename FunctionT, typename... ArgsT>
-bool is_exception_thrown(FunctionT func, ArgsT&&... args)
-{
-    bool is_thrown = false;
-
-    try
-    {
-        func(std::forward<ArgsT>(args)...);
-    }
-    catch (ExceptionT& ex)
-    {
-        return true;
-    }
-
-    return false;
-}
-
 constexpr is_equal::empty_type empty_value_0{};
 
 using hash_table_type = open_addressing_hash_set<   int
@@ -198,6 +183,346 @@ void test_hash_set_find_value                   (   hash_table_type const & tabl
     }
 }
 
+using move_only_table_type = open_addressing_hash_set<  std::unique_ptr<int>
+                                                     ,  pointee_hasher
+                                                     ,  is_pointee_equal
+                                                     >;
+
+using cache_table_type = open_addressing_hash_set<  int
+                                                 ,  simple_size_hasher
+                                                 ,  is_equal
+                                                 ,  clock_eviction
+                                                 >;
+
+using counted_cache_table_type = open_addressing_hash_set<  int
+                                                         ,  mixing_size_hasher
+                                                         ,  is_equal_counted
+                                                         ,  clock_eviction
+                                                         >;
+
+using expiring_cache_table_type = open_addressing_hash_set< int
+                                                          , simple_size_hasher
+                                                          , is_equal
+                                                          , clock_ttl_eviction<manual_clock>
+                                                          >;
+
+using copy_counted_table_type = open_addressing_hash_set<   copy_counted
+                                                        ,   copy_counted_hasher
+                                                        ,   is_copy_counted_equal
+                                                        >;
+
+void test_hash_set_move_only_keys               ()
+{
+    constexpr size_t hash_size = 7;
+
+    move_only_table_type table(hash_size, pointee_hasher(hash_size));
+
+    assert(table.emplace(std::make_unique<int>(1)));
+    assert(table.emplace(new int(8))); // Conflicting value
+    assert(!table.emplace(std::make_unique<int>(1)));
+    assert(table.size() == 2);
+
+    auto const probe = std::make_unique<int>(8);
+    assert(table.find(probe) != table.end());
+    assert(**table.find(probe) == 8);
+
+    table.rebalance(13, pointee_hasher(13));
+    assert(table.size() == 2);
+    assert(table.find(probe) != table.end());
+
+    move_only_table_type moved(std::move(table));
+    assert(moved.size() == 2);
+    assert(table.is_empty());
+    assert(table.begin() == table.end());
+
+    auto node = moved.extract(probe);
+    assert(node);
+    assert(*node.value() == 8);
+    assert(moved.size() == 1);
+    assert(moved.find(probe) == moved.end());
+    assert(moved.extract(probe).empty());
+
+    // Moved from node handles are empty.
+    auto handed_over = std::move(node);
+    assert(node.empty());
+    assert(*handed_over.value() == 8);
+    node = std::move(handed_over);
+    assert(handed_over.empty());
+    assert(!moved.insert(std::move(handed_over)));
+
+    move_only_table_type other(hash_size, pointee_hasher(hash_size));
+    assert(other.insert(std::move(node)));
+    assert(node.empty());
+    assert(other.find(probe) != other.end());
+    assert(!other.insert(std::move(node)));
+
+    assert(moved.erase(std::make_unique<int>(1)) == 1);
+    assert(moved.is_empty());
+}
+
+void test_hash_set_no_copies                    ()
+{
+    constexpr size_t hash_size = 11;
+
+    copy_counted_table_type table(hash_size, copy_counted_hasher(hash_size));
+
+    for (int value = 0; value < 8; ++value)
+    {
+        assert(table.emplace(value));
+    }
+    for (int value = 0; value < 3; ++value)
+    {
+        assert(table.emplace(copy_counted(value + hash_size))); // Conflicting values
+    }
+    assert(table.size() == hash_size);
+    assert(copy_counted::copies == 0);
+
+    table.rebalance(23, copy_counted_hasher(23));
+    assert(copy_counted::copies == 0);
+
+    auto node = table.extract(copy_counted(5));
+    copy_counted_table_type other(hash_size, copy_counted_hasher(hash_size));
+    assert(other.insert(std::move(node)));
+    assert(table.find(5) == table.end());
+    assert(table.insert(other.extract(other.begin())));
+    assert(table.find(5) != table.end());
+    assert(other.is_empty());
+    assert(copy_counted::copies == 0);
+
+    copy_counted_table_type copied(table);
+    assert(copy_counted::copies == table.size());
+    assert(copied.size() == table.size());
+}
+
+void test_hash_set_try_emplace                  ()
+{
+    constexpr size_t hash_size = 11;
+
+    using entry_type = std::pair<int, int>;
+
+    // Entries keyed by first, looked up by bare keys.
+    struct key_hasher
+    {
+        using is_transparent = void;
+
+        size_t operator ()(entry_type const & entry) const noexcept
+        {
+            return static_cast<size_t>(entry.first) % hash_size;
+        }
+
+        size_t operator ()(int key) const noexcept
+        {
+            return static_cast<size_t>(key) % hash_size;
+        }
+    };
+
+    struct is_key_equal
+    {
+        using is_transparent = void;
+
+        bool operator ()(entry_type const & lhs, entry_type const & rhs) const noexcept
+        {
+            return lhs.first == rhs.first;
+        }
+
+        bool operator ()(entry_type const & lhs, int rhs) const noexcept
+        {
+            return lhs.first == rhs;
+        }
+    };
+
+    open_addressing_hash_set<entry_type, key_hasher, is_key_equal> table(hash_size);
+
+    auto const [inserted, is_inserted] = table.try_emplace(3, 3, 30);
+    assert(is_inserted);
+    assert(inserted->second == 30);
+
+    // Present key: the arguments are not used.
+    auto const [found, is_found_inserted] = table.try_emplace(3, 3, 31);
+    assert(!is_found_inserted);
+    assert(found == inserted);
+    assert(found->second == 30);
+
+    assert(table.try_emplace(3 + hash_size, 3 + hash_size, 40).second); // Conflicting key
+    assert(table.find(3 + hash_size)->second == 40);
+    assert(table.find(4) == table.end());
+    assert(table.find(entry_type{3, 0})->second == 30);
+    table.prefetch(3);
+
+    assert(table.erase(table.find(3)) == table.find(3 + hash_size)); // Next occupied bucket
+    assert(table.find(3) == table.end());
+    assert(table.find(3 + hash_size)->second == 40);
+    assert(table.size() == 1);
+
+    table.clear();
+    assert(table.is_empty());
+    assert(table.capacity() == hash_size);
+    assert(table.begin() == table.end());
+    assert(table.find(3) == table.end());
+    assert(table.try_emplace(3, 3, 32).second);
+    assert(table.size() == 1);
+}
+
+void test_hash_set_clock_eviction               ()
+{
+    constexpr size_t hash_size = 16;
+
+    cache_table_type table(hash_size, simple_size_hasher(hash_size), is_equal(), clock_eviction{4});
+    assert(table.max_size() == 4);
+
+    for (int value = 1; value <= 4; ++value)
+    {
+        assert(table.emplace(value));
+    }
+
+    // Second chance for referenced values. The hand steps by 9 buckets (0, 9, 2, 11, 4, ...),
+    // so it evicts 4 and then 3.
+    assert(table.find(1) != table.end());
+    assert(!table.emplace(2));
+
+    assert(table.emplace(5));
+    assert(table.size() == 4);
+    assert(table.find(4) == table.end());
+
+    assert(table.emplace(6));
+    assert(table.size() == 4);
+    assert(table.find(3) == table.end());
+
+    for (int value : {1, 2, 5, 6})
+    {
+        assert(table.find(value) != table.end());
+    }
+
+    // Default bound is three quarters of the capacity.
+    cache_table_type default_table(hash_size, simple_size_hasher(hash_size));
+    assert(default_table.max_size() == 12);
+}
+
+void test_hash_set_clock_eviction_stream        ()
+{
+    constexpr size_t hash_size = 61;
+
+    cache_table_type table(hash_size, simple_size_hasher(hash_size));
+
+    // Unbounded stream never fills the table with erased buckets.
+    for (int value = 0; value < 100'000; ++value)
+    {
+        table.emplace(value * 7);
+        assert(table.size() <= table.max_size());
+        assert(table.find(value * 7) != table.end());
+
+        if (value % 3 == 0) table.erase(value * 7);
+    }
+
+    assert(table.capacity() == hash_size);
+    assert(table.size() == table.max_size() - 1); // The last value was erased
+}
+
+void test_hash_set_clock_eviction_concurrent_find ()
+{
+    constexpr size_t hash_size = 16;
+
+    cache_table_type table(hash_size, simple_size_hasher(hash_size), is_equal(), clock_eviction{4});
+    for (int value = 1; value <= 4; ++value) table.emplace(value);
+
+    // Const finds set CLOCK marks with atomic stores, concurrent readers are safe.
+    cache_table_type const & shared = table;
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 4; ++reader)
+    {
+        readers.emplace_back    (   [&shared]()
+                                    {
+                                        for (int i = 0; i < 1000; ++i)
+                                        {
+                                            assert(shared.find(1 + i % 3) != shared.end());
+                                        }
+                                    }
+                                );
+    }
+    for (auto & reader : readers) reader.join();
+
+    // Marked 1, 2 and 3 get second chance, 4 is evicted.
+    assert(table.emplace(5));
+    assert(table.find(4) == table.end());
+    for (int value : {1, 2, 3, 5})
+    {
+        assert(table.find(value) != table.end());
+    }
+}
+
+// Average buckets compared per insert of an unbounded stream into a full cache.
+double cache_insert_cost                        (size_t hash_size, size_t max_size)
+{
+    counted_cache_table_type table(hash_size, mixing_size_hasher(hash_size), is_equal_counted(), clock_eviction{max_size});
+
+    size_t const count = 10 * hash_size;
+    is_equal_counted::calls = 0;
+    for (size_t value = 0; value < count; ++value)
+    {
+        table.emplace(static_cast<int>(value));
+    }
+
+    return static_cast<double>(is_equal_counted::calls) / count;
+}
+
+void test_hash_set_clock_eviction_insert_cost   ()
+{
+    constexpr size_t small_size = 1'000;
+    constexpr size_t large_size = 8'000;
+
+    // Insert cost does not grow with capacity, also with the bound requested next to capacity.
+    for (size_t headroom : {size_t{0}, size_t{1}})
+    {
+        auto const small_cost = cache_insert_cost(small_size, headroom ? small_size - headroom : 0);
+        auto const large_cost = cache_insert_cost(large_size, headroom ? large_size - headroom : 0);
+
+        assert(small_cost < 256);
+        assert(large_cost < 2 * small_cost);
+    }
+
+    counted_cache_table_type table(small_size, mixing_size_hasher(small_size), is_equal_counted(), clock_eviction{small_size - 1});
+    assert(table.max_size() == small_size - small_size / 8);
+}
+
+void test_hash_set_ttl_eviction                 ()
+{
+    constexpr size_t hash_size = 16;
+
+    using namespace std::chrono_literals;
+
+    expiring_cache_table_type table (   hash_size
+                                    ,   simple_size_hasher(hash_size)
+                                    ,   is_equal()
+                                    ,   clock_ttl_eviction<manual_clock>{2, 10ns}
+                                    );
+
+    manual_clock::current = manual_clock::time_point(0ns);
+    assert(table.emplace(1));
+
+    manual_clock::current = manual_clock::time_point(5ns);
+    assert(table.find(1) != table.end());
+
+    manual_clock::current = manual_clock::time_point(20ns);
+    assert(table.find(1) == table.end());
+    assert(table.size() == 1);
+
+    // Expired entry is evicted even if referenced, unexpired referenced 2 gets second chance.
+    assert(table.emplace(2));
+    assert(table.find(2) != table.end());
+    assert(table.emplace(3));
+    assert(table.size() == 2);
+    assert(table.find(2) != table.end());
+    assert(table.find(3) != table.end());
+
+    // Emplace of an expired value refreshes it.
+    manual_clock::current = manual_clock::time_point(40ns);
+    assert(table.find(2) == table.end());
+    assert(table.emplace(2));
+    assert(table.find(2) != table.end());
+    assert(!table.emplace(2));
+    assert(table.size() == 2);
+}
+
 }
 
 int main(int argc, char * argv[])
@@ -212,4 +537,14 @@ int main(int argc, char * argv[])
     unit_test::test_hash_set_iterators(table, values);
     unit_test::test_hash_set_value_erase(table, {2, 42, 17});
     unit_test::test_hash_set_find_value(table, {1, 3, -1, 13, 30}, {42, 17, 55, unit_test::empty_value_0});
+
+    unit_test::test_hash_set_move_only_keys();
+    unit_test::test_hash_set_no_copies();
+    unit_test::test_hash_set_try_emplace();
+
+    unit_test::test_hash_set_clock_eviction();
+    unit_test::test_hash_set_clock_eviction_stream();
+    unit_test::test_hash_set_clock_eviction_concurrent_find();
+    unit_test::test_hash_set_clock_eviction_insert_cost();
+    unit_test::test_hash_set_ttl_eviction();
 }
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "QuotientHashSet.hpp"
+#include "TestHashTable.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace specialized_datatypes;
+
+namespace unit_test
+{
+
+using quotient_table_type = quotient_hash_set<>;
+
+void test_invertible_hash                       ()
+{
+    invertible_integer_hash<64> hasher64;
+    invertible_integer_hash<40> hasher40;
+    invertible_integer_hash<3>  hasher3;
+
+    for (uint64_t value : {0ull, 1ull, 42ull, 0xFFFF'FFFFull, 0x1234'5678'9ABC'DEF0ull, ~0ull})
+    {
+        assert(hasher64.inverse(hasher64(value)) == value);
+        auto const value40 = value & ((1ull << 40) - 1);
+        assert(hasher40(value40) < (1ull << 40));
+        assert(hasher40.inverse(hasher40(value40)) == value40);
+    }
+
+    std::set<uint64_t> hashes;
+    for (uint64_t value = 0; value < 8; ++value)
+    {
+        assert(hasher3.inverse(hasher3(value)) == value);
+        hashes.insert(hasher3(value));
+    }
+    assert(hashes.size() == 8);
+}
+
+void test_quotient_set_initialization           ()
+{
+    quotient_table_type table(1000);
+
+    assert(table.is_empty());
+    assert(table.size() == 0);
+    assert(table.capacity() == 1024);
+    // 10 quotient bits are implied by the position, 54 remainder bits and 8 displacement bits are stored.
+    assert(table.slot_width() == 64 - 10 + 8);
+    assert(table.begin() == table.end());
+
+    quotient_hash_set<48> narrow_table(1 << 20);
+    assert(narrow_table.slot_width() == 48 - 20 + 8);
+    assert(narrow_table.memory_usage() == (1 << 20) * 36 / 8);
+
+    quotient_hash_set<64> small_table(3);
+    assert(small_table.capacity() == 256);
+}
+
+void test_quotient_set_value_insert             (quotient_table_type & table, std::vector<uint64_t> const & values)
+{
+    for (auto value : values)
+    {
+        assert(table.emplace(value));
+    }
+    assert(table.size() == values.size());
+
+    for (auto value : values)
+    {
+        assert(!table.emplace(value));
+        assert(table.find(value) != table.end());
+        assert(*table.find(value) == value);
+    }
+    assert(table.size() == values.size());
+
+    std::multiset<uint64_t> iterated(table.begin(), table.end());
+    assert(iterated == std::multiset<uint64_t>(values.begin(), values.end()));
+    assert(static_cast<size_t>(std::distance(table.begin(), table.end())) == values.size());
+}
+
+void test_quotient_set_erase                    (quotient_table_type & table, std::vector<uint64_t> const & values)
+{
+    auto original_size = table.size();
+    for (size_t i = 0; i < values.size(); i += 2)
+    {
+        assert(table.erase(values[i]) == 1);
+        assert(table.erase(values[i]) == 0);
+        assert(table.find(values[i]) == table.end());
+    }
+    assert(table.size() == original_size - (values.size() + 1) / 2);
+
+    for (size_t i = 1; i < values.size(); i += 2)
+    {
+        assert(table.find(values[i]) != table.end());
+    }
+
+    for (size_t i = 0; i < values.size(); i += 2)
+    {
+        assert(table.emplace(values[i]));
+    }
+    assert(table.size() == original_size);
+}
+
+void test_quotient_set_rebalance                (quotient_table_type & table, std::vector<uint64_t> const & values)
+{
+    auto failed_rebalance = [&table](size_t s) {table.rebalance(s);};
+    assert(is_exception_thrown<quotient_table_type::rebalancing_size_too_small>(failed_rebalance, table.size() - 1));
+
+    table.rebalance(table.capacity() * 2);
+    assert(table.capacity() == 2048);
+    assert(table.size() == values.size());
+
+    for (auto value : values)
+    {
+        assert(table.find(value) != table.end());
+    }
+}
+
+void test_quotient_set_full                     ()
+{
+    using small_table_type = quotient_hash_set<8, 4>;
+
+    small_table_type table(0);
+    assert(table.capacity() == 16);
+
+    std::vector<uint64_t> inserted;
+    uint64_t value = 0;
+    for (; value < 256; ++value)
+    {
+        try
+        {
+            assert(table.emplace(value));
+            inserted.push_back(value);
+        }
+        catch (small_table_type::table_is_full & ex)
+        {
+            break;
+        }
+    }
+
+    // Failed insertion leaves the table untouched.
+    assert(value < 256);
+    assert(table.size() == inserted.size());
+    assert(table.find(value) == table.end());
+    for (auto v : inserted)
+    {
+        assert(table.find(v) != table.end());
+    }
+
+    // Keys wider than KeyBits are rejected.
+    assert(!table.emplace(256));
+}
+
+void test_quotient_set_iterators                (quotient_table_type const & table)
+{
+    auto it = table.begin();
+    assert(it != table.end());
+
+    auto first = *it;
+    assert(*(it++) == first);
+    assert(*(--it) == first);
+    --it;
+    assert(it == table.end());
+    --it;
+    assert(it != table.end());
+    ++it;
+    assert(it == table.end());
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    unit_test::test_invertible_hash();
+    unit_test::test_quotient_set_initialization();
+
+    std::mt19937_64 rng(17);
+    std::vector<uint64_t> values {0, 1, 2, 1000, ~0ull};
+    while (values.size() < 700) values.push_back(rng());
+
+    unit_test::quotient_table_type table(1000);
+    unit_test::test_quotient_set_value_insert(table, values);
+    unit_test::test_quotient_set_erase(table, values);
+    unit_test::test_quotient_set_rebalance(table, values);
+    unit_test::test_quotient_set_iterators(table);
+    unit_test::test_quotient_set_full();
+}
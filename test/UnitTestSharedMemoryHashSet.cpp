@@ -0,0 +1,200 @@
+#include "SharedMemoryHashSet.hpp"
+#include "TestHashTable.hpp"
+
+#include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace specialized_datatypes;
+
+namespace unit_test
+{
+
+constexpr size_t hash_size = 1021;
+
+constexpr is_equal::empty_type empty_value_0{};
+
+using shared_set_type = shared_memory_hash_set<int, simple_size_hasher, is_equal>;
+
+std::string segment_name (std::string const & test_name)
+{
+    return "/unit_test_" + test_name + "_" + std::to_string(::getpid());
+}
+
+// Runs function in a forked child process, which exits with 0 unless an assertion fails.
+template <typename FunctionT>
+pid_t run_child (FunctionT function)
+{
+    auto const child = ::fork();
+    assert(child >= 0);
+
+    if (child == 0)
+    {
+        function();
+        ::_exit(0);
+    }
+
+    return child;
+}
+
+bool is_child_succeeded (pid_t child)
+{
+    int status = 0;
+    return ::waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void test_shared_set_single_process             ()
+{
+    auto const name = segment_name("shared_set_single");
+    auto set = shared_set_type::create(name, hash_size, simple_size_hasher(hash_size));
+
+    assert(set.is_empty());
+    assert(!set.is_read_only());
+    assert(set.capacity() == hash_size);
+    assert(set.memory_usage() >= hash_size * sizeof(int));
+
+    assert(set.emplace(42));
+    assert(set.emplace(42 + hash_size)); // Conflicting key
+    assert(!set.emplace(42));
+    assert(!set.emplace(empty_value_0));
+    assert(set.size() == 2);
+
+    assert(set.contains(42));
+    assert(set.contains(42 + hash_size));
+    assert(!set.contains(43));
+    assert(!set.contains(empty_value_0));
+
+    size_t sum = 0;
+    set.for_each([&sum](int value) {sum += value;});
+    assert(sum == 84 + hash_size);
+
+    assert  (   is_exception_thrown<shared_set_type::shared_memory_error>(
+                    [&name]() {auto duplicate = shared_set_type::create(name, hash_size, simple_size_hasher(hash_size));}
+                )
+            );
+
+    auto moved = std::move(set);
+    assert(moved.contains(42));
+
+    shared_set_type::remove(name);
+    assert  (   is_exception_thrown<shared_set_type::shared_memory_error>(
+                    [&name]() {auto missing = shared_set_type::open(name);}
+                )
+            );
+
+    // Mapping outlives the name.
+    assert(moved.contains(42 + hash_size));
+}
+
+void test_shared_set_full                       ()
+{
+    auto const name = segment_name("shared_set_full");
+    auto set = shared_set_type::create(name, 3, simple_size_hasher(3));
+
+    assert(set.emplace(0));
+    assert(set.emplace(1));
+    assert(set.emplace(2));
+    assert(!set.emplace(1));
+    assert  (   is_exception_thrown<shared_set_type::table_is_full>(
+                    [&set]() {set.emplace(3);}
+                )
+            );
+    assert(!set.contains(3));
+
+    shared_set_type::remove(name);
+}
+
+void test_shared_set_read_only_workers          ()
+{
+    constexpr int workers_count = 4;
+
+    auto const name = segment_name("shared_set_read_only");
+    auto set = shared_set_type::create(name, hash_size, simple_size_hasher(hash_size));
+    for (int value = 0; value < 500; ++value) set.emplace(value * 7);
+
+    std::vector<pid_t> children;
+    for (int worker = 0; worker < workers_count; ++worker)
+    {
+        children.push_back  (   run_child   (   [&name]()
+                                                {
+                                                    auto const view = shared_set_type::open(name);
+                                                    assert(view.is_read_only());
+                                                    assert(view.size() == 500);
+
+                                                    for (int value = 0; value < 3500; ++value)
+                                                    {
+                                                        assert(view.contains(value) == (value % 7 == 0));
+                                                    }
+
+                                                    auto other_view = shared_set_type::open(name);
+                                                    assert  (   is_exception_thrown<shared_set_type::read_only_segment>(
+                                                                    [&other_view]() {other_view.emplace(1);}
+                                                                )
+                                                            );
+                                                }
+                                            )
+                            );
+    }
+
+    for (auto child : children)
+    {
+        assert(is_child_succeeded(child));
+    }
+
+    shared_set_type::remove(name);
+}
+
+void test_shared_set_concurrent_inserts         ()
+{
+    constexpr int workers_count = 4;
+    constexpr int values_count  = 200;
+
+    auto const name = segment_name("shared_set_inserts");
+    auto set = shared_set_type::create(name, hash_size, simple_size_hasher(hash_size));
+
+    // Overlapping ranges: every value is claimed by exactly one of the racing workers.
+    std::vector<pid_t> children;
+    for (int worker = 0; worker < workers_count; ++worker)
+    {
+        children.push_back  (   run_child   (   [&name, worker]()
+                                                {
+                                                    auto view = shared_set_type::open(name, shared_set_type::access_mode::read_write);
+                                                    for (int value = worker * values_count / 2; value < (worker + 2) * values_count / 2; ++value)
+                                                    {
+                                                        view.emplace(value);
+                                                        assert(view.contains(value));
+                                                    }
+                                                }
+                                            )
+                            );
+    }
+
+    for (auto child : children)
+    {
+        assert(is_child_succeeded(child));
+    }
+
+    constexpr int total = (workers_count + 1) * values_count / 2;
+    assert(set.size() == total);
+    for (int value = 0; value < total; ++value)
+    {
+        assert(set.contains(value));
+    }
+    assert(!set.contains(total));
+
+    shared_set_type::remove(name);
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    unit_test::test_shared_set_single_process();
+    unit_test::test_shared_set_full();
+    unit_test::test_shared_set_read_only_workers();
+    unit_test::test_shared_set_concurrent_inserts();
+}
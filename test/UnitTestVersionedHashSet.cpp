@@ -0,0 +1,159 @@
+#include "HashTable.hpp"
+#include "VersionedHashSet.hpp"
+#include "TestHashTable.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace specialized_datatypes;
+
+namespace unit_test
+{
+
+constexpr size_t hash_size = 211;
+
+using hash_table_type = open_addressing_hash_set<   int
+                                                ,   simple_size_hasher
+                                                ,   is_equal
+                                                >;
+
+using versioned_table_type = versioned_hash_set<hash_table_type, 8>;
+
+hash_table_type make_table                      (int count)
+{
+    hash_table_type table(hash_size, simple_size_hasher(hash_size));
+    for (int value = 0; value < count; ++value) table.emplace(value);
+    return table;
+}
+
+void test_versioned_set_publish                 ()
+{
+    versioned_table_type versioned(make_table(10));
+    auto reader = versioned.make_reader();
+
+    assert(versioned.version() == 0);
+    assert(reader.contains(9));
+    assert(!reader.contains(10));
+
+    {
+        auto snapshot = reader.pin();
+        assert(snapshot.version() == 0);
+
+        assert(versioned.publish(make_table(20)) == 1);
+        assert(versioned.update([](hash_table_type & table) {table.emplace(100);}) == 2);
+
+        // Pinned version stays intact and is not reclaimed.
+        assert(snapshot->size() == 10);
+        assert(snapshot->find(15) == snapshot->end());
+        assert(versioned.retired_count() == 2);
+        assert(versioned.collect() == 0);
+    }
+
+    assert(versioned.collect() == 2);
+    assert(versioned.retired_count() == 0);
+
+    auto snapshot = reader.pin();
+    assert(snapshot.version() == 2);
+    assert(snapshot->size() == 21);
+    assert(snapshot->find(15) != snapshot->end());
+    assert(snapshot->find(100) != snapshot->end());
+}
+
+void test_versioned_set_nested_pins            ()
+{
+    versioned_table_type versioned(make_table(10));
+    auto reader = versioned.make_reader();
+
+    {
+        auto outer = reader.pin();
+        assert(versioned.publish(make_table(20)) == 1);
+
+        // Nested pin through the same reader must not unpin the outer snapshot.
+        assert(reader.contains(15));
+        {
+            auto inner = reader.pin();
+            assert(inner.version() == 1);
+        }
+
+        assert(versioned.collect() == 0);
+        assert(versioned.retired_count() == 1);
+        assert(outer.version() == 0);
+        assert(outer->size() == 10);
+    }
+
+    assert(versioned.collect() == 1);
+}
+
+void test_versioned_set_readers                 ()
+{
+    versioned_table_type versioned(make_table(0));
+
+    std::vector<versioned_table_type::reader> readers;
+    for (size_t i = 0; i < 8; ++i) readers.push_back(versioned.make_reader());
+
+    assert  (   is_exception_thrown<versioned_table_type::too_many_readers>(
+                    [&versioned]() {auto r = versioned.make_reader();}
+                )
+            );
+
+    readers.pop_back();
+    auto reader = versioned.make_reader();
+    assert(!reader.contains(1));
+}
+
+void test_versioned_set_concurrent_readers      ()
+{
+    constexpr int versions_count = 200;
+
+    versioned_table_type versioned(make_table(0));
+    std::atomic<bool> is_done {false};
+
+    // Every version n holds exactly values [0, n), readers must never see a partial table.
+    auto read_loop = [&versioned, &is_done]()
+    {
+        auto reader = versioned.make_reader();
+        uint64_t last_version = 0;
+        while (!is_done.load())
+        {
+            auto snapshot = reader.pin();
+            assert(snapshot.version() >= last_version);
+            last_version = snapshot.version();
+
+            auto const count = static_cast<int>(snapshot->size());
+            assert(count == static_cast<int>(last_version));
+            for (int value = 0; value < count; ++value)
+            {
+                assert(snapshot->find(value) != snapshot->end());
+            }
+            assert(snapshot->find(count) == snapshot->end());
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) readers.emplace_back(read_loop);
+
+    for (int value = 0; value < versions_count; ++value)
+    {
+        versioned.update([value](hash_table_type & table) {table.emplace(value);});
+    }
+
+    is_done.store(true);
+    for (auto & thread : readers) thread.join();
+
+    versioned.collect();
+    assert(versioned.retired_count() == 0);
+    assert(versioned.version() == versions_count);
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    unit_test::test_versioned_set_publish();
+    unit_test::test_versioned_set_nested_pins();
+    unit_test::test_versioned_set_readers();
+    unit_test::test_versioned_set_concurrent_readers();
+}